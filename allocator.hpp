@@ -0,0 +1,425 @@
+#ifndef __lib_allocator_hpp__
+#define __lib_allocator_hpp__
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include <lib/basic_types.hpp>
+#include <lib/meta.hpp>
+
+namespace lib
+{
+  template <typename A>
+  concept Allocator = requires(A &a, void *p, Size n, Size align)
+  {
+    a.allocate(n, align);
+    a.deallocate(p, n, align);
+  };
+
+  template <typename A>
+  concept ReallocatableAllocator = Allocator<A> &&
+      requires(A &a, void *p, Size old, Size n, Size align)
+  {
+    a.reallocate(p, old, n, align);
+  };
+
+  constexpr Size MaxAlign = alignof(std::max_align_t);
+
+  constexpr Size align_up(Size n, Size align) noexcept
+  {
+    return (n + align - 1) & ~(align - 1);
+  }
+
+  inline char *align_up(char *p, Size align) noexcept
+  {
+    return reinterpret_cast<char *>(
+        align_up(reinterpret_cast<Size>(p), align));
+  }
+
+  struct HeapAllocator
+  {
+    void *allocate(Size n, Size align) const noexcept
+    {
+      if (n == 0)
+        return nullptr;
+
+      if (align <= MaxAlign)
+        return std::malloc(n);
+      else
+        return std::aligned_alloc(align, align_up(n, align));
+    }
+
+    void *reallocate(void *p, Size old, Size n, Size align) const noexcept
+    {
+      if (align <= MaxAlign)
+        return std::realloc(p, n);
+
+      void *np = allocate(n, align);
+
+      if (p != nullptr)
+      {
+        std::memcpy(np, p, old < n ? old : n);
+        std::free(p);
+      }
+
+      return np;
+    }
+
+    void deallocate(void *p, Size, Size) const noexcept
+    {
+      std::free(p);
+    }
+
+    constexpr bool operator==(const HeapAllocator &) const noexcept
+    {
+      return true;
+    }
+  };
+
+  // Monotonic arena : memory is bump allocated from
+  // chunks and only given back by release().
+  class Arena
+  {
+    struct Chunk
+    {
+      Chunk *next;
+    };
+
+    static constexpr Size header = align_up(sizeof(Chunk), MaxAlign);
+
+    Chunk *chunks = nullptr;
+    char *cur = nullptr;
+    char *last = nullptr;
+    char *prev = nullptr;
+    Size csize = 64 * 1024;
+
+  public:
+    constexpr Arena() noexcept = default;
+
+    explicit constexpr Arena(Size _csize) noexcept
+        : csize(_csize) {}
+
+    Arena(const Arena &) = delete;
+    Arena(Arena &&) = delete;
+    Arena &operator=(const Arena &) = delete;
+    Arena &operator=(Arena &&) = delete;
+
+    ~Arena() noexcept
+    {
+      release();
+    }
+
+  private:
+    void grow(Size n) noexcept
+    {
+      Size size = header + (n > csize ? n : csize);
+      Chunk *c = static_cast<Chunk *>(std::malloc(size));
+      c->next = chunks;
+      chunks = c;
+      cur = reinterpret_cast<char *>(c) + header;
+      last = reinterpret_cast<char *>(c) + size;
+    }
+
+  public:
+    void *allocate(Size n, Size align) noexcept
+    {
+      if (n == 0)
+        return nullptr;
+
+      char *p = cur != nullptr ? align_up(cur, align) : nullptr;
+
+      if (p == nullptr || p > last || n > Size(last - p))
+      {
+        grow(n + align);
+        p = align_up(cur, align);
+      }
+
+      prev = p;
+      cur = p + n;
+      return p;
+    }
+
+    void *reallocate(void *p, Size old, Size n, Size align) noexcept
+    {
+      if (p != nullptr && p == prev && n <= Size(last - prev))
+      {
+        cur = prev + n;
+        return p;
+      }
+
+      void *np = allocate(n, align);
+
+      if (p != nullptr)
+        std::memcpy(np, p, old < n ? old : n);
+
+      return np;
+    }
+
+    void deallocate(void *p, Size n, Size) noexcept
+    {
+      if (p != nullptr && p == prev && prev + n == cur)
+      {
+        cur = prev;
+        prev = nullptr;
+      }
+    }
+
+    void release() noexcept
+    {
+      while (chunks != nullptr)
+      {
+        Chunk *next = chunks->next;
+        std::free(chunks);
+        chunks = next;
+      }
+
+      cur = nullptr;
+      last = nullptr;
+      prev = nullptr;
+    }
+  };
+
+  struct ArenaAllocator
+  {
+    Arena *arena = nullptr;
+
+    void *allocate(Size n, Size align) const noexcept
+    {
+      return arena->allocate(n, align);
+    }
+
+    void *reallocate(void *p, Size old, Size n, Size align) const noexcept
+    {
+      return arena->reallocate(p, old, n, align);
+    }
+
+    void deallocate(void *p, Size n, Size align) const noexcept
+    {
+      arena->deallocate(p, n, align);
+    }
+
+    constexpr bool operator==(const ArenaAllocator &o) const noexcept
+    {
+      return arena == o.arena;
+    }
+  };
+
+  // Fixed size blocks pool : requests bigger than
+  // the block size are served by the heap.
+  class Pool
+  {
+    struct Node
+    {
+      Node *next;
+    };
+
+    static constexpr Size header = align_up(sizeof(Node), MaxAlign);
+
+    Node *chunks = nullptr;
+    Node *free = nullptr;
+    Size bsize;
+    Size bcount;
+
+  public:
+    explicit constexpr Pool(Size _bsize, Size _bcount = 256) noexcept
+        : bsize(align_up(_bsize < sizeof(Node) ? sizeof(Node) : _bsize, MaxAlign)),
+          bcount(_bcount == 0 ? 1 : _bcount) {}
+
+    Pool(const Pool &) = delete;
+    Pool(Pool &&) = delete;
+    Pool &operator=(const Pool &) = delete;
+    Pool &operator=(Pool &&) = delete;
+
+    ~Pool() noexcept
+    {
+      release();
+    }
+
+  private:
+    void refill() noexcept
+    {
+      Node *c = static_cast<Node *>(std::malloc(header + bsize * bcount));
+      c->next = chunks;
+      chunks = c;
+
+      char *b = reinterpret_cast<char *>(c) + header;
+
+      for (Size i = bcount; i > 0; --i)
+      {
+        Node *n = reinterpret_cast<Node *>(b + (i - 1) * bsize);
+        n->next = free;
+        free = n;
+      }
+    }
+
+  public:
+    constexpr Size block_size() const noexcept
+    {
+      return bsize;
+    }
+
+    void *allocate(Size n, Size align) noexcept
+    {
+      if (n > bsize || align > MaxAlign)
+        return HeapAllocator().allocate(n, align);
+
+      if (free == nullptr)
+        refill();
+
+      Node *n0 = free;
+      free = free->next;
+      return n0;
+    }
+
+    void deallocate(void *p, Size n, Size align) noexcept
+    {
+      if (p == nullptr)
+        return;
+
+      if (n > bsize || align > MaxAlign)
+        HeapAllocator().deallocate(p, n, align);
+      else
+      {
+        Node *n0 = static_cast<Node *>(p);
+        n0->next = free;
+        free = n0;
+      }
+    }
+
+    void release() noexcept
+    {
+      while (chunks != nullptr)
+      {
+        Node *next = chunks->next;
+        std::free(chunks);
+        chunks = next;
+      }
+
+      free = nullptr;
+    }
+  };
+
+  struct PoolAllocator
+  {
+    Pool *pool = nullptr;
+
+    void *allocate(Size n, Size align) const noexcept
+    {
+      return pool->allocate(n, align);
+    }
+
+    void deallocate(void *p, Size n, Size align) const noexcept
+    {
+      pool->deallocate(p, n, align);
+    }
+
+    constexpr bool operator==(const PoolAllocator &o) const noexcept
+    {
+      return pool == o.pool;
+    }
+  };
+
+  // Per thread free lists of power of two size classes
+  // in front of the heap. Any thread may free a block.
+  struct CachingAllocator
+  {
+    static constexpr Size min_shift = 4;
+    static constexpr Size max_shift = 12;
+    static constexpr Size nclasses = max_shift - min_shift + 1;
+    static constexpr Size depth = 64;
+
+  private:
+    struct Node
+    {
+      Node *next;
+    };
+
+    struct Cache
+    {
+      Node *heads[nclasses] = {};
+      Size counts[nclasses] = {};
+
+      ~Cache() noexcept
+      {
+        for (Node *head : heads)
+          while (head != nullptr)
+          {
+            Node *next = head->next;
+            std::free(head);
+            head = next;
+          }
+      }
+    };
+
+    static Cache &cache() noexcept
+    {
+      static thread_local Cache c;
+      return c;
+    }
+
+    static constexpr Size sclass(Size n) noexcept
+    {
+      Size shift = min_shift;
+
+      while ((Size(1) << shift) < n)
+        ++shift;
+
+      return shift - min_shift;
+    }
+
+    static constexpr bool cached(Size n, Size align) noexcept
+    {
+      return n != 0 &&
+             n <= (Size(1) << max_shift) &&
+             align <= MaxAlign;
+    }
+
+  public:
+    void *allocate(Size n, Size align) const noexcept
+    {
+      if (!cached(n, align))
+        return HeapAllocator().allocate(n, align);
+
+      Size c = sclass(n);
+      Cache &ch = cache();
+
+      if (ch.heads[c] == nullptr)
+        return std::malloc(Size(1) << (c + min_shift));
+
+      Node *n0 = ch.heads[c];
+      ch.heads[c] = n0->next;
+      --ch.counts[c];
+      return n0;
+    }
+
+    void deallocate(void *p, Size n, Size align) const noexcept
+    {
+      if (p == nullptr)
+        return;
+
+      if (!cached(n, align))
+        return HeapAllocator().deallocate(p, n, align);
+
+      Size c = sclass(n);
+      Cache &ch = cache();
+
+      if (ch.counts[c] >= depth)
+        std::free(p);
+      else
+      {
+        Node *n0 = static_cast<Node *>(p);
+        n0->next = ch.heads[c];
+        ch.heads[c] = n0;
+        ++ch.counts[c];
+      }
+    }
+
+    constexpr bool operator==(const CachingAllocator &) const noexcept
+    {
+      return true;
+    }
+  };
+}
+
+#endif
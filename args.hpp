@@ -4,46 +4,22 @@
 #include <lib/string.hpp>
 #include <lib/array.hpp>
 #include <lib/basic_types.hpp>
+#include <lib/parse.hpp>
 
 namespace lib
 {
+  // Whole string as a number, 0 when it is not one
+  // or when it does not fit.
   constexpr int toint(StringView s) noexcept
   {
-    int res = 0;
-
-    bool neg = s.range().starts_with(sv("-"));
-    bool pos = s.range().starts_with(sv("+"));
-
-    if (pos || neg)
-    {
-      auto tmp = s.sub(1);
-      s = StringView(tmp.begin(), tmp.end());
-    }
-
-    bool all_digits = s.range().all_of(
-        [](char c)
-        { return '0' <= c && c <= '9'; });
-
-    if (all_digits)
-      for (char c : s)
-        res = res * 10 + (c - '0');
-
-    return neg ? -res : res;
+    Parsed<int> p = parse<int>(s);
+    return p.ok() && p.consumed == s.size() ? p.value : 0;
   }
 
   constexpr Size touint(StringView s) noexcept
   {
-    Size res = 0;
-
-    bool all_digits = s.range().all_of(
-        [](char c)
-        { return '0' <= c && c <= '9'; });
-
-    if (all_digits)
-      for (char c : s)
-        res = res * 10 + (c - '0');
-
-    return res;
+    Parsed<Size> p = parse<Size>(s);
+    return p.ok() && p.consumed == s.size() ? p.value : 0;
   }
 
   class CommandLine
@@ -0,0 +1,301 @@
+#ifndef __lib_clock_hpp__
+#define __lib_clock_hpp__
+
+#include <time.h>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define LIB_TSC 1
+#else
+#define LIB_TSC 0
+#endif
+
+#include <lib/basic_types.hpp>
+#include <lib/iostream.hpp>
+
+// Nanosecond clocks. All of them count from the same
+// origin as CLOCK_MONOTONIC, so their values can be
+// compared; wall() counts from the Unix epoch.
+namespace lib::clock
+{
+  inline unsigned long long read(clockid_t id) noexcept
+  {
+    ::timespec ts;
+    ::clock_gettime(id, &ts);
+    return (unsigned long long)(ts.tv_sec) * 1000000000ull +
+           (unsigned long long)(ts.tv_nsec);
+  }
+
+  inline unsigned long long monotonic() noexcept
+  {
+    return read(CLOCK_MONOTONIC);
+  }
+
+  // Cheaper, at the resolution of the scheduler tick.
+  inline unsigned long long coarse() noexcept
+  {
+#if defined(CLOCK_MONOTONIC_COARSE)
+    return read(CLOCK_MONOTONIC_COARSE);
+#else
+    return read(CLOCK_MONOTONIC);
+#endif
+  }
+
+  // Time stamp counter scaled to CLOCK_MONOTONIC. The ratio
+  // is measured once, over 10 ms, and never refreshed : its
+  // error accumulates, so the counter suits durations more
+  // than the timestamps of a long running process. Falls
+  // back to CLOCK_MONOTONIC when the counter is missing or
+  // not invariant across cores and P-states.
+  class Tsc
+  {
+    unsigned long long t0 = 0;
+    unsigned long long n0 = 0;
+    unsigned long long mult = 0;
+    bool usable = false;
+
+  public:
+    static unsigned long long ticks() noexcept
+    {
+#if LIB_TSC
+      return __rdtsc();
+#else
+      return 0;
+#endif
+    }
+
+    static bool invariant() noexcept
+    {
+#if LIB_TSC
+      unsigned a, b, c, d;
+
+      if (__get_cpuid(0x80000000, &a, &b, &c, &d) == 0 || a < 0x80000007)
+        return false;
+
+      __get_cpuid(0x80000007, &a, &b, &c, &d);
+      return (d & (1u << 8)) != 0;
+#else
+      return false;
+#endif
+    }
+
+    static Tsc calibrated() noexcept
+    {
+      Tsc t;
+
+      if (!invariant())
+        return t;
+
+      t.n0 = monotonic();
+      t.t0 = ticks();
+
+      ::timespec ts{0, 10000000};
+      ::nanosleep(&ts, nullptr);
+
+      unsigned long long n1 = monotonic();
+      unsigned long long t1 = ticks();
+
+      if (t1 <= t.t0)
+        return t;
+
+      t.mult = (unsigned long long)(((unsigned __int128)(n1 - t.n0) << 32) /
+                                    (t1 - t.t0));
+      t.usable = true;
+      return t;
+    }
+
+    bool enabled() const noexcept
+    {
+      return usable;
+    }
+
+    unsigned long long now() const noexcept
+    {
+      if (!usable)
+        return monotonic();
+
+      return n0 + (unsigned long long)(((unsigned __int128)(ticks() - t0) * mult) >> 32);
+    }
+  };
+
+  // Calibrated on first use, which sleeps for 10 ms :
+  // call it at startup to keep that off a hot path.
+  inline const Tsc &tsc() noexcept
+  {
+    static const Tsc t = Tsc::calibrated();
+    return t;
+  }
+
+  enum class source : int
+  {
+    tsc = 0,
+    monotonic = 1,
+    coarse = 2
+  };
+
+  inline int selected = int(source::monotonic);
+
+  // Clock behind now(), wall() and the logger, monotonic
+  // by default. Selecting tsc makes reads cheaper but
+  // calibrates it, see tsc().
+  inline void select(source s) noexcept
+  {
+    __atomic_store_n(&selected, int(s), __ATOMIC_RELAXED);
+  }
+
+  inline unsigned long long now() noexcept
+  {
+    switch (source(__atomic_load_n(&selected, __ATOMIC_RELAXED)))
+    {
+    case source::tsc:
+      return tsc().now();
+    case source::coarse:
+      return coarse();
+    default:
+      return monotonic();
+    }
+  }
+
+  // Nanoseconds since the Unix epoch, from the realtime
+  // clock matching the selected one, so following NTP. The
+  // tsc has none : it is offset once from CLOCK_REALTIME.
+  inline unsigned long long wall() noexcept
+  {
+    switch (source(__atomic_load_n(&selected, __ATOMIC_RELAXED)))
+    {
+    case source::tsc:
+    {
+      static const unsigned long long offset =
+          read(CLOCK_REALTIME) - monotonic();
+
+      return tsc().now() + offset;
+    }
+    case source::coarse:
+#if defined(CLOCK_REALTIME_COARSE)
+      return read(CLOCK_REALTIME_COARSE);
+#else
+      return read(CLOCK_REALTIME);
+#endif
+    default:
+      return read(CLOCK_REALTIME);
+    }
+  }
+
+  // Elapsed time from now(), for benchmarks.
+  class Stopwatch
+  {
+    unsigned long long start = now();
+
+  public:
+    void restart() noexcept
+    {
+      start = now();
+    }
+
+    unsigned long long elapsed() const noexcept
+    {
+      return now() - start;
+    }
+  };
+
+  // "YYYY-MM-DDTHH:MM:SS" of a second since the epoch.
+  // The date and the minute are only formatted again
+  // when the minute changes, the seconds otherwise.
+  class DateCache
+  {
+    unsigned long long minute = ~0ull;
+    char text[19];
+
+    static void two(char *p, unsigned v) noexcept
+    {
+      p[0] = digits100[2 * v];
+      p[1] = digits100[2 * v + 1];
+    }
+
+  public:
+    const char *at(unsigned long long sec) noexcept
+    {
+      if (sec / 60 != minute)
+      {
+        minute = sec / 60;
+
+        // Days to civil date, from H. Hinnant's algorithms.
+        unsigned long long z = sec / 86400 + 719468;
+        unsigned long long era = z / 146097;
+        unsigned doe = unsigned(z - era * 146097);
+        unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        unsigned mp = (5 * doy + 2) / 153;
+        unsigned d = doy - (153 * mp + 2) / 5 + 1;
+        unsigned m = mp < 10 ? mp + 3 : mp - 9;
+        unsigned y = unsigned(yoe + era * 400 + (m <= 2 ? 1 : 0));
+        unsigned s = unsigned(sec % 86400);
+
+        two(text, y / 100 % 100);
+        two(text + 2, y % 100);
+        text[4] = '-';
+        two(text + 5, m);
+        text[7] = '-';
+        two(text + 8, d);
+        text[10] = 'T';
+        two(text + 11, s / 3600);
+        text[13] = ':';
+        two(text + 14, s / 60 % 60);
+        text[16] = ':';
+      }
+
+      two(text + 17, unsigned(sec % 60));
+      return text;
+    }
+  };
+
+  struct Iso8601
+  {
+    unsigned long long ns;
+    int digits;
+  };
+
+  template <Output OUT>
+  inline OUT &operator<<(OUT &buff, Iso8601 t) noexcept
+  {
+    static thread_local DateCache cache;
+    static constexpr unsigned long long scales[] = {
+        1000000000, 100000000, 10000000, 1000000, 100000,
+        10000, 1000, 100, 10, 1};
+
+    char tmp[31];
+    Size n = 19;
+
+    std::memcpy(tmp, cache.at(t.ns / 1000000000), 19);
+
+    if (t.digits != 0)
+    {
+      unsigned long long frac = t.ns % 1000000000 / scales[t.digits];
+      Size k = digits10(frac);
+
+      tmp[n++] = '.';
+      std::memset(tmp + n, '0', Size(t.digits) - k);
+      format10(tmp + n + Size(t.digits) - k, frac, k);
+      n += Size(t.digits);
+    }
+
+    tmp[n++] = 'Z';
+    return buff << StringView(tmp, n);
+  }
+
+  constexpr OutputSize operator+(OutputSize size, Iso8601 t) noexcept
+  {
+    return {size.size + 20 + (t.digits != 0 ? Size(t.digits) + 1 : 0)};
+  }
+
+  // UTC time of ns since the epoch with digits (0 to 9)
+  // fractional digits, as 2026-10-17T12:34:56.123456Z.
+  constexpr Iso8601 iso8601(unsigned long long ns, int digits = 6) noexcept
+  {
+    return Iso8601{ns, digits < 0 ? 0 : digits > 9 ? 9 : digits};
+  }
+}
+
+#endif
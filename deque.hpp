@@ -0,0 +1,480 @@
+#ifndef __lib_deque_hpp__
+#define __lib_deque_hpp__
+
+#include <new>
+#include <cstring>
+
+#include <lib/basic_types.hpp>
+#include <lib/range.hpp>
+#include <lib/utility.hpp>
+#include <lib/span.hpp>
+#include <lib/allocator.hpp>
+
+namespace lib
+{
+  // Ring buffer with a power of two capacity : pushes
+  // and pops at both ends are amortized O(1).
+  template <typename T, Allocator A = HeapAllocator>
+  class Deque
+  {
+    T *storage = nullptr;
+    Size head = 0;
+    Size lgth = 0;
+    Size max = 0;
+    [[no_unique_address]] A alloc;
+
+    struct Iterator
+    {
+      Deque *d;
+      Size i = 0;
+
+      constexpr Iterator &operator++() noexcept
+      {
+        ++i;
+        return *this;
+      }
+
+      constexpr Iterator operator++(int) noexcept
+      {
+        auto tmp = *this;
+        ++(*this);
+        return tmp;
+      }
+
+      constexpr Iterator operator+(Size n) const noexcept
+      {
+        return Iterator{d, i + n};
+      }
+
+      constexpr Size operator-(const Iterator &o) const noexcept
+      {
+        return i - o.i;
+      }
+
+      constexpr bool operator==(const Iterator &o) const noexcept
+      {
+        return i == o.i;
+      }
+
+      constexpr bool operator!=(const Iterator &o) const noexcept
+      {
+        return !(*this == o);
+      }
+
+      constexpr T &operator*() const noexcept
+      {
+        return (*d)[i];
+      }
+
+      constexpr T &operator[](Size n) const noexcept
+      {
+        return (*d)[i + n];
+      }
+    };
+
+    struct ConstIterator
+    {
+      const Deque *d;
+      Size i = 0;
+
+      constexpr ConstIterator &operator++() noexcept
+      {
+        ++i;
+        return *this;
+      }
+
+      constexpr ConstIterator operator++(int) noexcept
+      {
+        auto tmp = *this;
+        ++(*this);
+        return tmp;
+      }
+
+      constexpr ConstIterator operator+(Size n) const noexcept
+      {
+        return ConstIterator{d, i + n};
+      }
+
+      constexpr Size operator-(const ConstIterator &o) const noexcept
+      {
+        return i - o.i;
+      }
+
+      constexpr bool operator==(const ConstIterator &o) const noexcept
+      {
+        return i == o.i;
+      }
+
+      constexpr bool operator!=(const ConstIterator &o) const noexcept
+      {
+        return !(*this == o);
+      }
+
+      constexpr const T &operator*() const noexcept
+      {
+        return (*d)[i];
+      }
+
+      constexpr const T &operator[](Size n) const noexcept
+      {
+        return (*d)[i + n];
+      }
+    };
+
+  public:
+    template <typename S>
+    struct Segments
+    {
+      S first;
+      S second;
+    };
+
+    template <typename... U>
+    static constexpr Deque from(U &&...us) noexcept
+    {
+      Deque d(sizeof...(U));
+      (d.push_back(forward<U>(us)), ...);
+      return d;
+    }
+
+  private:
+    constexpr Size index(Size i) const noexcept
+    {
+      return (head + i) & (max - 1);
+    }
+
+    constexpr void destroy() noexcept
+    {
+      for (Size i = 0; i < lgth; ++i)
+        storage[index(i)].~T();
+
+      lgth = 0;
+      head = 0;
+    }
+
+    constexpr void deallocate() noexcept
+    {
+      if (storage != nullptr)
+        alloc.deallocate(storage, max * sizeof(T), alignof(T));
+
+      storage = nullptr;
+      max = 0;
+    }
+
+    constexpr void grow(Size nmax) noexcept
+    {
+      T *nstorage = static_cast<T *>(
+          alloc.allocate(nmax * sizeof(T), alignof(T)));
+
+      if constexpr (TriviallyRelocatable<T>)
+      {
+        auto [first, second] = segments();
+
+        if (!first.empty())
+          std::memcpy(static_cast<void *>(nstorage),
+                      first.begin(), first.size() * sizeof(T));
+
+        if (!second.empty())
+          std::memcpy(static_cast<void *>(nstorage + first.size()),
+                      second.begin(), second.size() * sizeof(T));
+      }
+      else
+        for (Size i = 0; i < lgth; ++i)
+        {
+          new (nstorage + i) T(move(storage[index(i)]));
+          storage[index(i)].~T();
+        }
+
+      deallocate();
+      storage = nstorage;
+      max = nmax;
+      head = 0;
+    }
+
+    static constexpr Size ceil2(Size n) noexcept
+    {
+      Size p = 1;
+
+      while (p < n)
+        p <<= 1;
+
+      return p;
+    }
+
+  public:
+    constexpr Deque() noexcept = default;
+
+    explicit constexpr Deque(A a) noexcept
+        : alloc(a)
+    {
+    }
+
+    explicit constexpr Deque(Size _max, A a = A()) noexcept
+        : alloc(a)
+    {
+      if (_max != 0)
+        grow(ceil2(_max));
+    }
+
+    template <typename IT>
+    constexpr Deque(IT b, IT e, A a = A()) noexcept
+        : Deque(a)
+    {
+      append(b, e);
+    }
+
+    constexpr Deque(const Deque &o) noexcept
+        : Deque(o.lgth, o.alloc)
+    {
+      append(o.begin(), o.end());
+    }
+
+    constexpr Deque(Deque &&o) noexcept
+        : storage(o.storage),
+          head(o.head),
+          lgth(o.lgth),
+          max(o.max),
+          alloc(o.alloc)
+    {
+      o.storage = nullptr;
+      o.head = 0;
+      o.lgth = 0;
+      o.max = 0;
+    }
+
+    constexpr ~Deque() noexcept
+    {
+      destroy();
+      deallocate();
+    }
+
+    constexpr Deque &operator=(const Deque &o) noexcept
+    {
+      if (this != &o)
+      {
+        destroy();
+
+        if (max < o.lgth)
+        {
+          deallocate();
+          grow(ceil2(o.lgth));
+        }
+
+        append(o.begin(), o.end());
+      }
+
+      return *this;
+    }
+
+    constexpr Deque &operator=(Deque &&o) noexcept
+    {
+      if (this != &o)
+      {
+        destroy();
+        deallocate();
+        storage = o.storage;
+        head = o.head;
+        lgth = o.lgth;
+        max = o.max;
+        alloc = o.alloc;
+        o.storage = nullptr;
+        o.head = 0;
+        o.lgth = 0;
+        o.max = 0;
+      }
+
+      return *this;
+    }
+
+  public:
+    constexpr auto range() noexcept
+    {
+      return rangeof(*this);
+    }
+
+    constexpr auto range() const noexcept
+    {
+      return rangeof(*this);
+    }
+
+    constexpr Size size() const noexcept
+    {
+      return lgth;
+    }
+
+    constexpr Size capacity() const noexcept
+    {
+      return max;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+      return lgth == 0;
+    }
+
+    constexpr A allocator() const noexcept
+    {
+      return alloc;
+    }
+
+    constexpr Segments<Span<T>> segments() noexcept
+    {
+      if (head + lgth <= max)
+        return {Span<T>(storage + head, lgth), Span<T>()};
+      else
+        return {Span<T>(storage + head, max - head),
+                Span<T>(storage, head + lgth - max)};
+    }
+
+    constexpr Segments<Span<const T>> segments() const noexcept
+    {
+      if (head + lgth <= max)
+        return {Span<const T>(storage + head, lgth), Span<const T>()};
+      else
+        return {Span<const T>(storage + head, max - head),
+                Span<const T>(storage, head + lgth - max)};
+    }
+
+  public:
+    constexpr void clear() noexcept
+    {
+      destroy();
+    }
+
+    constexpr void push_back(const T &t) noexcept
+    {
+      if (lgth == max)
+        grow(max == 0 ? 16 : max * 2);
+
+      new (storage + index(lgth)) T(t);
+      ++lgth;
+    }
+
+    constexpr void push_back(T &&t) noexcept
+    {
+      if (lgth == max)
+        grow(max == 0 ? 16 : max * 2);
+
+      new (storage + index(lgth)) T(move(t));
+      ++lgth;
+    }
+
+    constexpr void push_front(const T &t) noexcept
+    {
+      if (lgth == max)
+        grow(max == 0 ? 16 : max * 2);
+
+      head = (head - 1) & (max - 1);
+      new (storage + head) T(t);
+      ++lgth;
+    }
+
+    constexpr void push_front(T &&t) noexcept
+    {
+      if (lgth == max)
+        grow(max == 0 ? 16 : max * 2);
+
+      head = (head - 1) & (max - 1);
+      new (storage + head) T(move(t));
+      ++lgth;
+    }
+
+    constexpr void pop_back() noexcept
+    {
+      if (lgth != 0)
+      {
+        storage[index(lgth - 1)].~T();
+        --lgth;
+      }
+    }
+
+    constexpr void pop_front() noexcept
+    {
+      if (lgth != 0)
+      {
+        storage[head].~T();
+        head = (head + 1) & (max - 1);
+        --lgth;
+      }
+    }
+
+    template <typename IT>
+    constexpr void append(IT b, IT e) noexcept
+    {
+      while (b != e)
+      {
+        push_back(*b);
+        ++b;
+      }
+    }
+
+    constexpr void append(Span<T> sp) noexcept
+    {
+      append(sp.begin(), sp.end());
+    }
+
+    constexpr void append(Span<const T> sp) noexcept
+    {
+      append(sp.begin(), sp.end());
+    }
+
+    constexpr T &front() noexcept
+    {
+      return storage[head];
+    }
+
+    constexpr const T &front() const noexcept
+    {
+      return storage[head];
+    }
+
+    constexpr T &back() noexcept
+    {
+      return storage[index(lgth - 1)];
+    }
+
+    constexpr const T &back() const noexcept
+    {
+      return storage[index(lgth - 1)];
+    }
+
+    constexpr T &operator[](Size i) noexcept
+    {
+      return storage[index(i)];
+    }
+
+    constexpr const T &operator[](Size i) const noexcept
+    {
+      return storage[index(i)];
+    }
+
+  public:
+    constexpr Iterator begin() noexcept
+    {
+      return Iterator{this, 0};
+    }
+
+    constexpr Iterator end() noexcept
+    {
+      return Iterator{this, lgth};
+    }
+
+    constexpr ConstIterator begin() const noexcept
+    {
+      return ConstIterator{this, 0};
+    }
+
+    constexpr ConstIterator end() const noexcept
+    {
+      return ConstIterator{this, lgth};
+    }
+  };
+}
+
+template <typename T, typename A>
+struct meta::TriviallyRelocatable<lib::Deque<T, A>>
+{
+  static constexpr bool value = ::TriviallyRelocatable<A>;
+};
+
+#endif
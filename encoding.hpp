@@ -0,0 +1,393 @@
+#ifndef __lib_encoding_hpp__
+#define __lib_encoding_hpp__
+
+#include <lib/basic_types.hpp>
+#include <lib/simd.hpp>
+
+namespace lib::encoding
+{
+  constexpr bool little = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+  struct HexPairs
+  {
+    char d[2 * 256];
+  };
+
+  // Two uppercase digits per byte value.
+  constexpr HexPairs hexpairs = []
+  {
+    constexpr char digits[] = "0123456789ABCDEF";
+    HexPairs t{};
+
+    for (Size i = 0; i < 256; ++i)
+    {
+      t.d[2 * i] = digits[i >> 4];
+      t.d[2 * i + 1] = digits[i & 15];
+    }
+
+    return t;
+  }();
+
+  struct BinOctets
+  {
+    char d[8 * 256];
+  };
+
+  // Eight digits per byte value, most significant first.
+  constexpr BinOctets binoctets = []
+  {
+    BinOctets t{};
+
+    for (Size i = 0; i < 256; ++i)
+      for (Size j = 0; j < 8; ++j)
+        t.d[8 * i + j] = char('0' + ((i >> (7 - j)) & 1));
+
+    return t;
+  }();
+
+  constexpr char base64chars[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  struct Base64Values
+  {
+    unsigned char v[256];
+  };
+
+  // Value of each base64 char, 0xFF for the others.
+  constexpr Base64Values base64values = []
+  {
+    Base64Values t{};
+
+    for (Size i = 0; i < 256; ++i)
+      t.v[i] = 0xFF;
+
+    for (Size i = 0; i < 64; ++i)
+      t.v[(unsigned char)(base64chars[i])] = (unsigned char)(i);
+
+    return t;
+  }();
+
+  // n bytes as 2 n hex digits at d. With PSHUFB (SSSE3, or
+  // its 32 bytes form with AVX2) each nibble indexes a 16
+  // digits table in a register, otherwise SSE2 compares and
+  // adds; the table above handles the tail.
+  constexpr void hex(const unsigned char *p, Size n, char *d) noexcept
+  {
+#if LIB_SIMD
+    if (!__builtin_is_constant_evaluated())
+    {
+#if defined(__AVX2__)
+      const __m256i nibble = _mm256_set1_epi8(0x0F);
+      const __m256i digits = _mm256_setr_epi8(
+          '0', '1', '2', '3', '4', '5', '6', '7',
+          '8', '9', 'A', 'B', 'C', 'D', 'E', 'F',
+          '0', '1', '2', '3', '4', '5', '6', '7',
+          '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+
+      for (; n >= 32; n -= 32, p += 32, d += 64)
+      {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i hi = _mm256_shuffle_epi8(
+            digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, nibble));
+
+        // Unpacking works within 128 bits lanes : the
+        // permutes put the lanes back in byte order.
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(d),
+                            _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(d + 32),
+                            _mm256_permute2x128_si256(a, b, 0x31));
+      }
+#endif
+
+#if defined(__SSSE3__)
+      const __m128i low = _mm_set1_epi8(0x0F);
+      const __m128i table = _mm_setr_epi8(
+          '0', '1', '2', '3', '4', '5', '6', '7',
+          '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+
+      for (; n >= 16; n -= 16, p += 16, d += 32)
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), low));
+        __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(v, low));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + 16), _mm_unpackhi_epi8(hi, lo));
+      }
+#else
+      const __m128i low = _mm_set1_epi8(0x0F);
+      const __m128i nine = _mm_set1_epi8(9);
+      const __m128i zero = _mm_set1_epi8('0');
+      const __m128i letters = _mm_set1_epi8('A' - '9' - 1);
+
+      auto ascii = [&](__m128i x)
+      {
+        __m128i over = _mm_cmpgt_epi8(x, nine);
+        return _mm_add_epi8(_mm_add_epi8(x, zero), _mm_and_si128(over, letters));
+      };
+
+      for (; n >= 16; n -= 16, p += 16, d += 32)
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low);
+        __m128i lo = _mm_and_si128(v, low);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d),
+                         ascii(_mm_unpacklo_epi8(hi, lo)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + 16),
+                         ascii(_mm_unpackhi_epi8(hi, lo)));
+      }
+#endif
+    }
+#endif
+
+    for (; n != 0; --n, ++p, d += 2)
+    {
+      d[0] = hexpairs.d[2 * *p];
+      d[1] = hexpairs.d[2 * *p + 1];
+    }
+  }
+
+  // n bytes as 8 n binary digits at d.
+  constexpr void bin(const unsigned char *p, Size n, char *d) noexcept
+  {
+#if LIB_SIMD && defined(__BMI2__)
+    if (little && !__builtin_is_constant_evaluated())
+    {
+      for (; n != 0; --n, ++p, d += 8)
+      {
+        unsigned long long bits = __builtin_bswap64(
+            _pdep_u64(*p, 0x0101010101010101ull));
+
+        bits += 0x3030303030303030ull;
+        __builtin_memcpy(d, &bits, 8);
+      }
+
+      return;
+    }
+#endif
+
+    for (; n != 0; --n, ++p, d += 8)
+      for (Size j = 0; j < 8; ++j)
+        d[j] = binoctets.d[8 * *p + j];
+  }
+
+  constexpr Size base64_size(Size n) noexcept
+  {
+    return (n + 2) / 3 * 4;
+  }
+
+  // n bytes as base64_size(n) chars at d, '=' padded. With
+  // PSHUFB, 12 bytes at a time are spread to 16 sextets, and
+  // a shuffled table gives the offset from each sextet to its
+  // char (Mula's method). The loads read 16 bytes, so the last
+  // 4 to 15 bytes and the padding stay on the scalar loop.
+  constexpr void base64(const unsigned char *p, Size n, char *d) noexcept
+  {
+#if LIB_SIMD && defined(__SSSE3__)
+    if (!__builtin_is_constant_evaluated())
+    {
+      const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+      const __m128i offsets = _mm_setr_epi8(
+          'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+          '/' - 63, 'A', 0, 0);
+
+      for (; n >= 16; n -= 12, p += 12, d += 16)
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+
+        // Each 32 bits lane holds 3 bytes as bbbbcccc aaaaaabb
+        // ccdddddd bbbbcccc : the multiplies move a, b, c and d
+        // to the low bits of their own byte.
+        v = _mm_shuffle_epi8(v, spread);
+
+        __m128i ac = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0FC0FC00)),
+                                     _mm_set1_epi32(0x04000040));
+        __m128i bd = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003F03F0)),
+                                     _mm_set1_epi32(0x01000010));
+        __m128i sextets = _mm_or_si128(ac, bd);
+
+        // 0 for a-z, 1 to 10 for digits, 11 for '+', 12 for
+        // '/' and 13 for A-Z.
+        __m128i range = _mm_subs_epu8(sextets, _mm_set1_epi8(51));
+        __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), sextets);
+        range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d),
+                         _mm_add_epi8(sextets, _mm_shuffle_epi8(offsets, range)));
+      }
+    }
+#endif
+
+    for (; n >= 3; n -= 3, p += 3, d += 4)
+    {
+      unsigned x = unsigned(p[0]) << 16 | unsigned(p[1]) << 8 | p[2];
+
+      d[0] = base64chars[x >> 18];
+      d[1] = base64chars[(x >> 12) & 63];
+      d[2] = base64chars[(x >> 6) & 63];
+      d[3] = base64chars[x & 63];
+    }
+
+    if (n != 0)
+    {
+      unsigned x = unsigned(p[0]) << 16 | (n == 2 ? unsigned(p[1]) << 8 : 0);
+
+      d[0] = base64chars[x >> 18];
+      d[1] = base64chars[(x >> 12) & 63];
+      d[2] = n == 2 ? base64chars[(x >> 6) & 63] : '=';
+      d[3] = '=';
+    }
+  }
+
+  // Count of bytes s decodes to, assuming it is valid.
+  constexpr Size unbase64_size(const char *s, Size n) noexcept
+  {
+    if (n < 4)
+      return 0;
+
+    Size pads = (s[n - 1] == '=') + (s[n - 2] == '=');
+    return n / 4 * 3 - pads;
+  }
+
+  // Whether s is padded base64.
+  constexpr bool isbase64(const char *s, Size n) noexcept
+  {
+    if (n % 4 != 0)
+      return false;
+
+    Size pads = n == 0 ? 0 : (s[n - 1] == '=') + (s[n - 2] == '=');
+
+    if (pads == 1 && s[n - 1] != '=')
+      return false;
+
+    unsigned bad = 0;
+
+    for (Size i = 0; i < n - pads; ++i)
+      bad |= base64values.v[(unsigned char)(s[i])];
+
+    return (bad & 0x80) == 0;
+  }
+
+  // Decodes the n chars of s at d. Gives the count of bytes
+  // written, or Size(-1) when s is not padded base64 : the
+  // bytes at d are then meaningless. Invalid chars are
+  // or'ed together and checked once at the end. With PSHUFB,
+  // 16 chars at a time are checked and turned into sextets
+  // by tables indexed by their nibbles, then packed to 12
+  // bytes; the last group, which may be padded, stays scalar.
+  constexpr Size unbase64(const char *s, Size n, unsigned char *d) noexcept
+  {
+    if (n % 4 != 0)
+      return Size(-1);
+
+    if (n == 0)
+      return 0;
+
+    auto value = [](char c)
+    {
+      return unsigned(base64values.v[(unsigned char)(c)]);
+    };
+
+    unsigned char *b = d;
+    unsigned bad = 0;
+
+#if LIB_SIMD && defined(__SSSE3__)
+    if (!__builtin_is_constant_evaluated())
+    {
+      const __m128i nibble = _mm_set1_epi8(0x0F);
+
+      // By high nibble, the offset from a char to its sextet,
+      // '/' aside : it shares its high nibble with '+'.
+      const __m128i shifts = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71,
+                                           0, 0, 0, 0, 0, 0, 0, 0);
+
+      // By low nibble, the set of high nibbles making a valid
+      // char, as bits of the byte the high nibble selects.
+      const __m128i valid = _mm_setr_epi8(
+          char(0xA8), char(0xF8), char(0xF8), char(0xF8), char(0xF8), char(0xF8),
+          char(0xF8), char(0xF8), char(0xF8), char(0xF8), char(0xF0), 0x54,
+          0x50, 0x50, 0x50, 0x54);
+      const __m128i bits = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, char(0x80),
+                                         0, 0, 0, 0, 0, 0, 0, 0);
+      const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                         -1, -1, -1, -1);
+
+      for (; n > 16; n -= 16, s += 16, d += 12)
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+        __m128i hi = _mm_and_si128(_mm_srli_epi32(v, 4), nibble);
+        __m128i lo = _mm_and_si128(v, nibble);
+
+        __m128i allowed = _mm_and_si128(_mm_shuffle_epi8(valid, lo),
+                                        _mm_shuffle_epi8(bits, hi));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(allowed, _mm_setzero_si128())) != 0)
+          return Size(-1);
+
+        __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+        __m128i shift = _mm_or_si128(_mm_andnot_si128(slash, _mm_shuffle_epi8(shifts, hi)),
+                                     _mm_and_si128(slash, _mm_set1_epi8(16)));
+
+        // Sextets pairs to 12 bits, then to 24 bits, one group
+        // per 32 bits lane, and their 3 bytes in order.
+        v = _mm_maddubs_epi16(_mm_add_epi8(v, shift), _mm_set1_epi32(0x01400140));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+        v = _mm_shuffle_epi8(v, pack);
+
+        int last = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(d), v);
+        __builtin_memcpy(d + 8, &last, 4);
+      }
+    }
+#endif
+
+    for (; n > 4; n -= 4, s += 4, d += 3)
+    {
+      unsigned a0 = value(s[0]), a1 = value(s[1]);
+      unsigned a2 = value(s[2]), a3 = value(s[3]);
+
+      bad |= a0 | a1 | a2 | a3;
+
+      unsigned x = a0 << 18 | a1 << 12 | a2 << 6 | a3;
+
+      d[0] = (unsigned char)(x >> 16);
+      d[1] = (unsigned char)(x >> 8);
+      d[2] = (unsigned char)(x);
+    }
+
+    unsigned pads = (s[3] == '=') + (s[2] == '=');
+
+    if (pads == 1 && s[3] != '=')
+      return Size(-1);
+
+    unsigned a0 = value(s[0]), a1 = value(s[1]);
+    unsigned a2 = pads >= 2 ? 0 : value(s[2]);
+    unsigned a3 = pads >= 1 ? 0 : value(s[3]);
+
+    bad |= a0 | a1 | a2 | a3;
+
+    if (bad & 0x80)
+      return Size(-1);
+
+    unsigned x = a0 << 18 | a1 << 12 | a2 << 6 | a3;
+
+    *d++ = (unsigned char)(x >> 16);
+
+    if (pads < 2)
+      *d++ = (unsigned char)(x >> 8);
+
+    if (pads < 1)
+      *d++ = (unsigned char)(x);
+
+    return Size(d - b);
+  }
+}
+
+#endif
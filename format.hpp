@@ -0,0 +1,226 @@
+#ifndef __lib_format_hpp__
+#define __lib_format_hpp__
+
+#include <lib/basic_types.hpp>
+#include <lib/string.hpp>
+#include <lib/iostream.hpp>
+
+namespace lib
+{
+  // Not constexpr : reaching it while parsing a format
+  // string makes the parse fail to compile.
+  void invalid_format_string(const char *why) noexcept;
+
+  // Placeholder options : {} writes the argument as <<
+  // does, {:x} as hex, {:b} as bin, {:f} and {:e} as fixed
+  // and scientific, with an optional precision ({:.3f}).
+  struct FormatSpec
+  {
+    char type = 0;
+    int precision = 6;
+  };
+
+  struct FormatPiece
+  {
+    Size b = 0;
+    Size n = 0;
+    bool arg = false;
+    Size index = 0;
+    FormatSpec spec;
+  };
+
+  // Format string parsed at compile time into the literal
+  // runs and the placeholders it alternates. "{{" and "}}"
+  // stand for '{' and '}'.
+  template <Size N>
+  struct FormatString
+  {
+    char s[N] = {};
+    FormatPiece pieces[N] = {};
+    Size npieces = 0;
+    Size nargs = 0;
+
+    consteval FormatString(const char (&str)[N]) noexcept
+    {
+      for (Size i = 0; i < N; ++i)
+        s[i] = str[i];
+
+      Size i = 0;
+      Size last = N - 1;
+
+      while (i < last)
+      {
+        if (s[i] == '{' && i + 1 < last && s[i + 1] == '{')
+        {
+          literal(i, 1);
+          i += 2;
+        }
+        else if (s[i] == '}' && i + 1 < last && s[i + 1] == '}')
+        {
+          literal(i, 1);
+          i += 2;
+        }
+        else if (s[i] == '}')
+          invalid_format_string("unmatched '}'");
+        else if (s[i] == '{')
+          i = placeholder(i + 1);
+        else
+        {
+          literal(i, 1);
+          ++i;
+        }
+      }
+    }
+
+  private:
+    consteval void literal(Size b, Size n) noexcept
+    {
+      if (npieces != 0)
+      {
+        FormatPiece &p = pieces[npieces - 1];
+
+        if (!p.arg && p.b + p.n == b)
+        {
+          p.n += n;
+          return;
+        }
+      }
+
+      pieces[npieces++] = FormatPiece{b, n, false, 0, {}};
+    }
+
+    consteval Size placeholder(Size i) noexcept
+    {
+      FormatSpec spec;
+
+      if (i < N - 1 && s[i] == ':')
+      {
+        ++i;
+
+        if (i < N - 1 && s[i] == '.')
+        {
+          ++i;
+
+          if (i == N - 1 || s[i] < '0' || s[i] > '9')
+            invalid_format_string("precision without digits");
+
+          spec.precision = 0;
+
+          for (; i < N - 1 && '0' <= s[i] && s[i] <= '9'; ++i)
+            spec.precision = spec.precision * 10 + (s[i] - '0');
+
+          if (s[i] != 'f' && s[i] != 'e')
+            invalid_format_string("precision applies to f and e only");
+        }
+
+        if (s[i] == 'x' || s[i] == 'b' || s[i] == 'f' || s[i] == 'e')
+          spec.type = s[i++];
+      }
+
+      if (i == N - 1 || s[i] != '}')
+        invalid_format_string("unterminated or unknown placeholder");
+
+      pieces[npieces++] = FormatPiece{0, 0, true, nargs++, spec};
+      return i + 1;
+    }
+  };
+
+  template <Size K, typename T, typename... R>
+  constexpr const auto &nth(const T &t, const R &...r) noexcept
+  {
+    if constexpr (K == 0)
+      return t;
+    else
+      return nth<K - 1>(r...);
+  }
+
+  template <FormatSpec S, typename T>
+  constexpr decltype(auto) specified(const T &t) noexcept
+  {
+    if constexpr (S.type == 'x')
+      return hex(t);
+    else if constexpr (S.type == 'b')
+      return bin(t);
+    else if constexpr (S.type == 'f')
+      return fixed(t, S.precision);
+    else if constexpr (S.type == 'e')
+      return scientific(t, S.precision);
+    else
+      return (t);
+  }
+
+  template <FormatString F, Size I, Output OUT, typename... Args>
+  constexpr void formatted(OUT &out, const Args &...args) noexcept
+  {
+    if constexpr (I < F.npieces)
+    {
+      constexpr FormatPiece p = F.pieces[I];
+
+      if constexpr (p.arg)
+        out << specified<p.spec>(nth<p.index>(args...));
+      else
+        out << StringView(F.s + p.b, p.n);
+
+      formatted<F, I + 1>(out, args...);
+    }
+  }
+
+  template <FormatString F, Size I, typename... Args>
+  constexpr OutputSize formatted(OutputSize size, const Args &...args) noexcept
+  {
+    if constexpr (I < F.npieces)
+    {
+      constexpr FormatPiece p = F.pieces[I];
+
+      if constexpr (p.arg)
+        size = size + specified<p.spec>(nth<p.index>(args...));
+      else
+        size = size + StringView(F.s + p.b, p.n);
+
+      return formatted<F, I + 1>(size, args...);
+    }
+    else
+      return size;
+  }
+
+  // Arguments bound to a format string, written by << into
+  // any Output and sized by OutputSize as one argument.
+  template <FormatString F, typename W>
+  struct Format
+  {
+    W with;
+  };
+
+  template <Output OUT, FormatString F, typename W>
+  constexpr OUT &operator<<(OUT &buff, const Format<F, W> &f) noexcept
+  {
+    f.with([&buff](const auto &...args) {
+      formatted<F, 0>(buff, args...);
+    });
+
+    return buff;
+  }
+
+  template <FormatString F, typename W>
+  constexpr OutputSize operator+(OutputSize size, const Format<F, W> &f) noexcept
+  {
+    return f.with([size](const auto &...args) {
+      return formatted<F, 0>(size, args...);
+    });
+  }
+
+  // Binds args to F, as print(format<"x={} y={:x}">(x, y)).
+  // The arguments are referenced : use it within the
+  // expression that writes it.
+  template <FormatString F, typename... Args>
+  constexpr auto format(const Args &...args) noexcept
+  {
+    static_assert(F.nargs == sizeof...(Args),
+                  "format string and argument count differ");
+
+    auto with = [&args...](auto &&f) { return f(args...); };
+    return Format<F, decltype(with)>{with};
+  }
+}
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef __lib_inplace_vector_hpp__
+#define __lib_inplace_vector_hpp__
+
+#include <new>
+
+#include <lib/basic_types.hpp>
+#include <lib/range.hpp>
+#include <lib/utility.hpp>
+#include <lib/span.hpp>
+
+namespace lib
+{
+  // Fixed capacity vector that never allocates :
+  // every push is limited as Vector::lpush_back.
+  template <typename T, Size N>
+    requires(N > 0)
+  class InplaceVector
+  {
+    Size lgth = 0;
+    alignas(T) unsigned char buff[N * sizeof(T)];
+
+  public:
+    template <typename... U>
+    static constexpr InplaceVector from(U &&...us) noexcept
+    {
+      InplaceVector v;
+      (v.push_back(forward<U>(us)), ...);
+      return v;
+    }
+
+  private:
+    constexpr T *storage() noexcept
+    {
+      return reinterpret_cast<T *>(buff);
+    }
+
+    constexpr const T *storage() const noexcept
+    {
+      return reinterpret_cast<const T *>(buff);
+    }
+
+  public:
+    constexpr InplaceVector() noexcept = default;
+
+    template <typename IT>
+    constexpr InplaceVector(IT b, IT e) noexcept
+        : InplaceVector()
+    {
+      append(b, e);
+    }
+
+    constexpr InplaceVector(const InplaceVector &o) noexcept
+        : InplaceVector()
+    {
+      append(o.begin(), o.end());
+    }
+
+    constexpr InplaceVector(InplaceVector &&o) noexcept
+        : InplaceVector()
+    {
+      for (T &t : o)
+        push_back(move(t));
+
+      o.clear();
+    }
+
+    constexpr ~InplaceVector() noexcept
+    {
+      clear();
+    }
+
+    constexpr InplaceVector &operator=(const InplaceVector &o) noexcept
+    {
+      if (this != &o)
+      {
+        clear();
+        append(o.begin(), o.end());
+      }
+
+      return *this;
+    }
+
+    constexpr InplaceVector &operator=(InplaceVector &&o) noexcept
+    {
+      if (this != &o)
+      {
+        clear();
+
+        for (T &t : o)
+          push_back(move(t));
+
+        o.clear();
+      }
+
+      return *this;
+    }
+
+  public:
+    constexpr auto range() noexcept
+    {
+      return rangeof(*this);
+    }
+
+    constexpr auto range() const noexcept
+    {
+      return rangeof(*this);
+    }
+
+    constexpr Size size() const noexcept
+    {
+      return lgth;
+    }
+
+    constexpr Size capacity() const noexcept
+    {
+      return N;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+      return lgth == 0;
+    }
+
+    constexpr bool full() const noexcept
+    {
+      return lgth == N;
+    }
+
+    constexpr T *data() noexcept
+    {
+      return storage();
+    }
+
+    constexpr const T *data() const noexcept
+    {
+      return storage();
+    }
+
+  public:
+    constexpr void clear() noexcept
+    {
+      for (Size i = 0; i < lgth; ++i)
+        storage()[i].~T();
+
+      lgth = 0;
+    }
+
+  public:
+    constexpr void lpush_back(const T &t) noexcept
+    {
+      if (lgth < N)
+      {
+        new (storage() + lgth) T(t);
+        ++lgth;
+      }
+    }
+
+    constexpr void lpush_back(T &&t) noexcept
+    {
+      if (lgth < N)
+      {
+        new (storage() + lgth) T(move(t));
+        ++lgth;
+      }
+    }
+
+    constexpr void push_back(const T &t) noexcept
+    {
+      lpush_back(t);
+    }
+
+    constexpr void push_back(T &&t) noexcept
+    {
+      lpush_back(move(t));
+    }
+
+    template <typename IT>
+    constexpr void lappend(IT b, IT e) noexcept
+    {
+      while (b != e && lgth < N)
+      {
+        lpush_back(*b);
+        ++b;
+      }
+    }
+
+    constexpr void lappend(Span<T> sp) noexcept
+    {
+      lappend(sp.begin(), sp.end());
+    }
+
+    constexpr void lappend(Span<const T> sp) noexcept
+    {
+      lappend(sp.begin(), sp.end());
+    }
+
+    template <typename IT>
+    constexpr void append(IT b, IT e) noexcept
+    {
+      lappend(b, e);
+    }
+
+    constexpr void append(Span<T> sp) noexcept
+    {
+      lappend(sp.begin(), sp.end());
+    }
+
+    constexpr void append(Span<const T> sp) noexcept
+    {
+      lappend(sp.begin(), sp.end());
+    }
+
+    constexpr T &operator[](Size i) noexcept
+    {
+      return storage()[i];
+    }
+
+    constexpr const T &operator[](Size i) const noexcept
+    {
+      return storage()[i];
+    }
+
+    constexpr operator Span<const T>() const noexcept
+    {
+      return Span<const T>(data(), size());
+    }
+
+    constexpr operator Span<T>() noexcept
+    {
+      return Span<T>(data(), size());
+    }
+
+  public:
+    constexpr T *begin() noexcept
+    {
+      return storage();
+    }
+
+    constexpr T *end() noexcept
+    {
+      return storage() + lgth;
+    }
+
+    constexpr const T *begin() const noexcept
+    {
+      return storage();
+    }
+
+    constexpr const T *end() const noexcept
+    {
+      return storage() + lgth;
+    }
+  };
+}
+
+#endif
@@ -2,11 +2,20 @@
 #define __lib_fmt_iostream_hpp__
 
 #include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/uio.h>
 
 #include <lib/string.hpp>
 #include <lib/range.hpp>
 #include <lib/array.hpp>
 #include <lib/meta.hpp>
+#include <lib/strong.hpp>
+#include <lib/floating.hpp>
+#include <lib/parse.hpp>
+#include <lib/simd.hpp>
+#include <lib/encoding.hpp>
 
 namespace lib
 {
@@ -17,6 +26,17 @@ namespace lib
     out.append(char{});
   };
 
+  // Outputs able to lend their internal buffer : reserve(n)
+  // gives room for n chars (or nullptr), commit(n) keeps them.
+  template <typename OUT>
+  concept ReservableOutput = Output<OUT> && requires(OUT &out, Size n)
+  {
+    {
+      out.reserve(n)
+      } -> same_as<char *>;
+    out.commit(n);
+  };
+
   struct OutputSize
   {
     Size size = 0;
@@ -90,6 +110,263 @@ namespace lib
 
   using FileWriter = OutputWriter<FileOutput>;
 
+  template <typename T>
+  concept Viewable = requires(T &&t)
+  {
+    StringView(t);
+  };
+
+  // Output gathering a whole message for one writev(2) :
+  // arguments already laid out as chars (literals, Strings,
+  // views) are pointed at, as they live until the end of
+  // the call, and only formatted values and short views are
+  // copied to a scratch arena. Overflowing either the arena
+  // or the iovec table writes what was gathered so far.
+  class GatherOutput
+  {
+    static constexpr Size maxvecs = 64;
+    static constexpr Size arena = 1024;
+    static constexpr Size small = 32;
+
+    int fd;
+    Size nvecs = 0;
+    Size used = 0;
+    ::iovec vecs[maxvecs];
+    char scratch[arena];
+
+  public:
+    template <typename... Args>
+    explicit GatherOutput(int _fd, Args &&...args) noexcept
+        : fd(_fd)
+    {
+      (put(forward<Args>(args)), ...);
+      flush();
+    }
+
+    GatherOutput(const GatherOutput &) = delete;
+    GatherOutput &operator=(const GatherOutput &) = delete;
+
+  private:
+    template <typename T>
+    void put(T &&t) noexcept
+    {
+      if constexpr (Viewable<T>)
+      {
+        StringView v(t);
+
+        if (v.size() <= small)
+          append(v);
+        else
+          record(v.begin(), v.size());
+      }
+      else
+        *this << forward<T>(t);
+    }
+
+    void record(const char *p, Size n) noexcept
+    {
+      if (n == 0)
+        return;
+
+      if (nvecs != 0)
+      {
+        ::iovec &last = vecs[nvecs - 1];
+
+        if (static_cast<const char *>(last.iov_base) + last.iov_len == p)
+        {
+          last.iov_len += n;
+          return;
+        }
+      }
+
+      if (nvecs == maxvecs)
+        flush();
+
+      vecs[nvecs++] = ::iovec{const_cast<char *>(p), n};
+    }
+
+    void flush() noexcept
+    {
+      ::iovec *v = vecs;
+      Size n = nvecs;
+
+      while (n != 0)
+      {
+        auto w = ::writev(fd, v, int(n));
+
+        if (w < 0 && errno == EINTR)
+          continue;
+
+        if (w <= 0)
+          break;
+
+        Size done = Size(w);
+
+        while (n != 0 && done >= v->iov_len)
+        {
+          done -= v->iov_len;
+          ++v;
+          --n;
+        }
+
+        if (n != 0)
+        {
+          v->iov_base = static_cast<char *>(v->iov_base) + done;
+          v->iov_len -= done;
+        }
+      }
+
+      nvecs = 0;
+      used = 0;
+    }
+
+  public:
+    char *reserve(Size n) noexcept
+    {
+      if (n > arena - used || nvecs == maxvecs)
+        flush();
+
+      return n <= arena ? scratch + used : nullptr;
+    }
+
+    void commit(Size n) noexcept
+    {
+      record(scratch + used, n);
+      used += n;
+    }
+
+    void append(char c) noexcept
+    {
+      *reserve(1) = c;
+      commit(1);
+    }
+
+    void append(StringView sv) noexcept
+    {
+      if (sv.empty())
+        return;
+
+      if (char *p = reserve(sv.size()); p != nullptr)
+      {
+        std::memcpy(p, sv.begin(), sv.size());
+        commit(sv.size());
+      }
+      else
+      {
+        record(sv.begin(), sv.size());
+        flush();
+      }
+    }
+
+    void result() noexcept {}
+  };
+
+  using GatherWriter = OutputWriter<GatherOutput>;
+
+  // Output owning a user space buffer in front of a file
+  // descriptor : flushed with write(2) when full, on flush(),
+  // on destruction and, in line mode, after each '\n'.
+  // Not synchronized : one instance per thread.
+  class BufferedOutput
+  {
+    int fd;
+    bool line;
+    Size lgth = 0;
+    Size max;
+    Strong<char[]> buff;
+
+  public:
+    explicit BufferedOutput(int _fd, Size _max = 64 * 1024, bool _line = false) noexcept
+        : fd(_fd),
+          line(_line),
+          max(_max == 0 ? 1 : _max),
+          buff(Strong<char[]>::allocate(max))
+    {
+    }
+
+    BufferedOutput(const BufferedOutput &) = delete;
+    BufferedOutput &operator=(const BufferedOutput &) = delete;
+
+    ~BufferedOutput() noexcept
+    {
+      flush();
+    }
+
+  private:
+    void write(const char *p, Size n) noexcept
+    {
+      while (n != 0)
+      {
+        auto w = ::write(fd, p, n);
+
+        if (w < 0 && errno == EINTR)
+          continue;
+
+        if (w <= 0)
+          return;
+
+        p += w;
+        n -= Size(w);
+      }
+    }
+
+  public:
+    void flush() noexcept
+    {
+      write(buff, lgth);
+      lgth = 0;
+    }
+
+    char *reserve(Size n) noexcept
+    {
+      if (n > max - lgth)
+        flush();
+
+      return n <= max ? static_cast<char *>(buff) + lgth : nullptr;
+    }
+
+    void commit(Size n) noexcept
+    {
+      lgth += n;
+    }
+
+    void append(char c) noexcept
+    {
+      if (lgth == max)
+        flush();
+
+      buff[lgth++] = c;
+
+      if (line && c == '\n')
+        flush();
+    }
+
+    void append(StringView sv) noexcept
+    {
+      if (sv.size() > max - lgth)
+        flush();
+
+      if (sv.size() >= max)
+        write(sv.begin(), sv.size());
+      else
+      {
+        std::memcpy(static_cast<char *>(buff) + lgth, sv.begin(), sv.size());
+        lgth += sv.size();
+      }
+
+      if (line && sv.range().find('\n') != sv.end())
+        flush();
+    }
+
+    void result() noexcept {}
+  };
+
+  inline BufferedOutput &bstdout() noexcept
+  {
+    static BufferedOutput out(1, 64 * 1024, ::isatty(1) == 1);
+    return out;
+  }
+
   template <typename... Args>
   void print(Args &&...args) noexcept
   {
@@ -101,6 +378,184 @@ namespace lib
   {
     FileWriter().write(stdout, forward<Args>(args)..., '\n');
   }
+
+  template <typename... Args>
+  void print(BufferedOutput &out, Args &&...args) noexcept
+  {
+    (out << ... << forward<Args>(args));
+  }
+
+  template <typename... Args>
+  void println(BufferedOutput &out, Args &&...args) noexcept
+  {
+    (out << ... << forward<Args>(args)) << '\n';
+  }
+
+  // Input reading a file descriptor by large chunks into
+  // a reused buffer. Lines and tokens are views into that
+  // buffer, valid until the next call : the unread tail is
+  // moved to the front before each refill, and the buffer
+  // only grows for a token longer than itself.
+  // Not synchronized : one instance per thread.
+  class FileInput
+  {
+    int fd;
+    bool eof = false;
+    Size b = 0;
+    Size e = 0;
+    Size max;
+    Strong<char[]> buff;
+
+    static constexpr bool isspace(char c) noexcept
+    {
+      return c == ' ' || ('\t' <= c && c <= '\r');
+    }
+
+  public:
+    explicit FileInput(int _fd, Size _max = 64 * 1024) noexcept
+        : fd(_fd),
+          max(_max == 0 ? 1 : _max),
+          buff(Strong<char[]>::allocate(max))
+    {
+    }
+
+    FileInput(const FileInput &) = delete;
+    FileInput &operator=(const FileInput &) = delete;
+
+  private:
+    char *data() noexcept
+    {
+      return static_cast<char *>(buff);
+    }
+
+    bool refill() noexcept
+    {
+      if (eof)
+        return false;
+
+      if (b != 0)
+      {
+        std::memmove(data(), data() + b, e - b);
+        e -= b;
+        b = 0;
+      }
+
+      if (e == max)
+      {
+        auto nbuff = Strong<char[]>::allocate(max * 2);
+        std::memcpy(static_cast<char *>(nbuff), data(), e);
+        buff = move(nbuff);
+        max *= 2;
+      }
+
+      while (true)
+      {
+        auto r = ::read(fd, data() + e, max - e);
+
+        if (r < 0 && errno == EINTR)
+          continue;
+
+        if (r <= 0)
+        {
+          eof = true;
+          return false;
+        }
+
+        e += Size(r);
+        return true;
+      }
+    }
+
+    // Skips the chars matching skip, then gives the view up
+    // to the position found by stop and consumes the char
+    // there. Refills only resume the search where it ended.
+    template <typename SKIP, typename STOP>
+    StringView scan(SKIP skip, STOP stop) noexcept
+    {
+      do
+        while (b != e && skip(data()[b]))
+          ++b;
+      while (b == e && refill());
+
+      Size done = 0;
+
+      while (true)
+      {
+        const char *s = data() + b;
+        const char *last = data() + e;
+        const char *p = stop(s + done, last);
+
+        if (p != last)
+        {
+          b = Size(p - data()) + 1;
+          return StringView(s, Size(p - s));
+        }
+
+        done = e - b;
+
+        if (!refill())
+        {
+          StringView v(data() + b, e - b);
+          b = e;
+          return v;
+        }
+      }
+    }
+
+  public:
+    // false once everything was read.
+    bool more() noexcept
+    {
+      if (b == e)
+        refill();
+
+      return b != e;
+    }
+
+    // Next line without its '\n'. A final '\n' does not
+    // start an empty line : check more() before each call.
+    StringView next_line() noexcept
+    {
+      return scan(
+          [](char) { return false; },
+          [](const char *p, const char *l) { return simd::find(p, l, '\n'); });
+    }
+
+    // Next non empty run of chars other than delim,
+    // empty when the input is exhausted.
+    StringView next_token(char delim = ' ') noexcept
+    {
+      return scan(
+          [delim](char c) { return c == delim; },
+          [delim](const char *p, const char *l) { return simd::find(p, l, delim); });
+    }
+
+    // Next whitespace separated token read as an integer.
+    template <IsInteger T = long long>
+    Parsed<T> next_int() noexcept
+    {
+      StringView tk = scan(
+          [](char c) { return isspace(c); },
+          [](const char *p, const char *l) {
+            while (p != l && !isspace(*p))
+              ++p;
+            return p;
+          });
+
+      auto r = parse<T>(tk);
+
+      if (r.ok() && r.consumed != tk.size())
+        r = Parsed<T>{T(0), 0, ParseError::invalid};
+
+      return r;
+    }
+  };
+
+  inline FileInput &bstdin() noexcept
+  {
+    static FileInput in(0);
+    return in;
+  }
 }
 
 namespace lib
@@ -146,76 +601,182 @@ namespace lib
     return buff << (b ? sv("true") : sv("false"));
   }
 
-  constexpr OutputSize operator+(OutputSize size, bool) noexcept
+  constexpr OutputSize operator+(OutputSize size, bool b) noexcept
   {
-    return {size.size + 5};
+    return {size.size + (b ? 4 : 5)};
   }
 
-  class StackArray
+  constexpr unsigned long long pow10s[20] = {
+      1ull,
+      10ull,
+      100ull,
+      1000ull,
+      10000ull,
+      100000ull,
+      1000000ull,
+      10000000ull,
+      100000000ull,
+      1000000000ull,
+      10000000000ull,
+      100000000000ull,
+      1000000000000ull,
+      10000000000000ull,
+      100000000000000ull,
+      1000000000000000ull,
+      10000000000000000ull,
+      100000000000000000ull,
+      1000000000000000000ull,
+      10000000000000000000ull};
+
+  // log10 estimated from the bit length (1233 / 4096
+  // ~ log10(2)), then corrected by one comparison.
+  // v | 1 has as many digits as v and is never 0.
+  constexpr Size digits10(unsigned long long v) noexcept
   {
-    char data[40];
-    int i = -1;
+    v |= 1;
+    Size t = ((64 - Size(__builtin_clzll(v))) * 1233) >> 12;
+    return t + 1 - (v < pow10s[t]);
+  }
 
-  public:
-    constexpr void push(char c) noexcept { data[++i] = c; }
-    constexpr char pop() noexcept { return data[i--]; }
-    constexpr bool empty() noexcept { return i == -1; }
-  };
+  constexpr char digits100[] =
+      "00010203040506070809"
+      "10111213141516171819"
+      "20212223242526272829"
+      "30313233343536373839"
+      "40414243444546474849"
+      "50515253545556575859"
+      "60616263646566676869"
+      "70717273747576777879"
+      "80818283848586878889"
+      "90919293949596979899";
 
-  template <Output OUT, IsUnsignedInteger T>
-  constexpr OUT &operator<<(OUT &buff, T t) noexcept
+  // Writes the n = digits10(v) digits of v at p.
+  constexpr void format10(char *p, unsigned long long v, Size n) noexcept
   {
+    p += n;
 
-    StackArray tbuff;
+    while (v >= 100)
+    {
+      Size i = Size(v % 100) * 2;
+      v /= 100;
+      *--p = digits100[i + 1];
+      *--p = digits100[i];
+    }
 
-    if (t == 0)
-      buff.append('0');
+    if (v >= 10)
+    {
+      Size i = Size(v) * 2;
+      *--p = digits100[i + 1];
+      *--p = digits100[i];
+    }
     else
-      while (t != 0)
+      *--p = char('0' + v);
+  }
+
+  template <Output OUT>
+  constexpr OUT &format10(OUT &buff, unsigned long long v, bool neg) noexcept
+  {
+    Size n = digits10(v);
+    Size lgth = n + (neg ? 1 : 0);
+
+    if constexpr (ReservableOutput<OUT>)
+      if (char *p = buff.reserve(lgth); p != nullptr)
       {
-        tbuff.push("0123456789"[t % 10]);
-        t /= 10;
+        *p = '-';
+        format10(p + lgth - n, v, n);
+        buff.commit(lgth);
+        return buff;
       }
 
-    while (!tbuff.empty())
-      buff.append(tbuff.pop());
-
+    char tmp[21] = {'-'};
+    format10(tmp + lgth - n, v, n);
+    buff.append(StringView(tmp, lgth));
     return buff;
   }
 
-  template <Output OUT, IsSignedInteger T>
+  template <Output OUT, IsUnsignedInteger T>
   constexpr OUT &operator<<(OUT &buff, T t) noexcept
   {
+    return format10(buff, t, false);
+  }
 
-    bool neg = t < 0;
+  template <IsSignedInteger T>
+  constexpr unsigned long long magnitude(T t) noexcept
+  {
+    unsigned long long u = (unsigned long long)(t);
+    return t < 0 ? 0 - u : u;
+  }
 
-    T tmp = neg ? -t : t;
+  template <Output OUT, IsSignedInteger T>
+  constexpr OUT &operator<<(OUT &buff, T t) noexcept
+  {
+    return format10(buff, magnitude(t), t < 0);
+  }
 
-    StackArray tbuff;
+  template <IsUnsignedInteger T>
+  constexpr OutputSize operator+(OutputSize size, T t) noexcept
+  {
+    return {size.size + digits10(t)};
+  }
 
-    if (tmp == 0)
-      buff.append('0');
-    else
-      while (tmp != 0)
+  template <IsSignedInteger T>
+  constexpr OutputSize operator+(OutputSize size, T t) noexcept
+  {
+    return {size.size + digits10(magnitude(t)) + (t < 0 ? 1 : 0)};
+  }
+
+  // Encodes the n bytes at p with enc, giving sz(k) chars
+  // for k bytes : in place when the output lends its buffer,
+  // otherwise by chunks of IN bytes (then a multiple of the
+  // encoding group) through a local buffer.
+  template <Size IN, Size OUTMAX, Output OUT, typename ENC, typename SZ>
+  constexpr OUT &encoded(OUT &buff, const unsigned char *p, Size n,
+                         ENC enc, SZ sz) noexcept
+  {
+    if constexpr (ReservableOutput<OUT>)
+      if (char *d = buff.reserve(sz(n)); d != nullptr)
       {
-        tbuff.push("0123456789"[tmp % 10]);
-        tmp /= 10;
+        enc(p, n, d);
+        buff.commit(sz(n));
+        return buff;
       }
 
-    if (neg)
-      buff.append('-');
+    char tmp[OUTMAX];
 
-    while (!tbuff.empty())
-      buff.append(tbuff.pop());
+    while (n != 0)
+    {
+      Size k = n < IN ? n : IN;
+      enc(p, k, tmp);
+      buff << StringView(tmp, sz(k));
+      p += k;
+      n -= k;
+    }
 
     return buff;
   }
 
-  template <IsInteger T>
-  constexpr OutputSize operator+(OutputSize size, T) noexcept
+  using Bytes = Span<const unsigned char>;
+
+  // Bytes of an object, most significant first whatever
+  // the byte order, so that integers read as their value.
+  template <typename T>
+  struct ObjectBytes
   {
-    return {size.size + sizeof(T) * 4};
-  }
+    unsigned char d[sizeof(T)];
+
+    explicit ObjectBytes(const T &t) noexcept
+    {
+      std::memcpy(d, &t, sizeof(T));
+
+      if constexpr (encoding::little)
+        for (Size i = 0; i < sizeof(T) / 2; ++i)
+        {
+          unsigned char c = d[i];
+          d[i] = d[sizeof(T) - 1 - i];
+          d[sizeof(T) - 1 - i] = c;
+        }
+    }
+  };
 
   template <typename T>
   struct HexFormat
@@ -223,28 +784,37 @@ namespace lib
     const T &t;
   };
 
+  // Bytes are written in memory order.
+  template <>
+  struct HexFormat<Bytes>
+  {
+    Bytes t;
+  };
+
   template <Output OUT, typename T>
   constexpr OUT &operator<<(OUT &buff, HexFormat<T> h) noexcept
   {
-    constexpr StringView hextable = "0123456789ABCDEF";
-
-    const char *b = reinterpret_cast<const char *>(&h.t) - 1;
-    const char *e = reinterpret_cast<const char *>(&h.t) + sizeof(T) - 1;
+    auto enc = [](const unsigned char *p, Size n, char *d)
+    { encoding::hex(p, n, d); };
+    auto sz = [](Size n)
+    { return 2 * n; };
 
-    while (e != b)
+    if constexpr (same_as<T, Bytes>)
+      return encoded<128, 256>(buff, h.t.begin(), h.t.size(), enc, sz);
+    else
     {
-      buff << hextable[(*e & 0b11110000) >> 4]
-           << hextable[(*e & 0b00001111)];
-      --e;
+      ObjectBytes<T> o(h.t);
+      return encoded<128, 256>(buff, o.d, sizeof(T), enc, sz);
     }
-
-    return buff;
   }
 
   template <typename T>
   constexpr OutputSize operator+(OutputSize size, HexFormat<T> h) noexcept
   {
-    return {size.size + 2 * sizeof(T)};
+    if constexpr (same_as<T, Bytes>)
+      return {size.size + 2 * h.t.size()};
+    else
+      return {size.size + 2 * sizeof(T)};
   }
 
   template <typename T>
@@ -253,40 +823,48 @@ namespace lib
     return HexFormat<T>{t};
   }
 
+  constexpr HexFormat<Bytes> hex(Bytes bytes)
+  {
+    return HexFormat<Bytes>{bytes};
+  }
+
   template <typename T>
   struct BinFormat
   {
     const T &t;
   };
 
+  // Bytes are written in memory order.
+  template <>
+  struct BinFormat<Bytes>
+  {
+    Bytes t;
+  };
+
   template <Output OUT, typename T>
   constexpr OUT &operator<<(OUT &buff, BinFormat<T> h) noexcept
   {
-    constexpr StringView bintable = "01";
+    auto enc = [](const unsigned char *p, Size n, char *d)
+    { encoding::bin(p, n, d); };
+    auto sz = [](Size n)
+    { return 8 * n; };
 
-    const char *b = reinterpret_cast<const char *>(&h.t) - 1;
-    const char *e = reinterpret_cast<const char *>(&h.t) + sizeof(T) - 1;
-
-    while (e != b)
+    if constexpr (same_as<T, Bytes>)
+      return encoded<32, 256>(buff, h.t.begin(), h.t.size(), enc, sz);
+    else
     {
-      buff << bintable[(*e & 0b10000000) >> 7]
-           << bintable[(*e & 0b01000000) >> 6]
-           << bintable[(*e & 0b00100000) >> 5]
-           << bintable[(*e & 0b00010000) >> 4]
-           << bintable[(*e & 0b00001000) >> 3]
-           << bintable[(*e & 0b00000100) >> 2]
-           << bintable[(*e & 0b00000010) >> 1]
-           << bintable[(*e & 0b00000001)];
-      --e;
+      ObjectBytes<T> o(h.t);
+      return encoded<32, 256>(buff, o.d, sizeof(T), enc, sz);
     }
-
-    return buff;
   }
 
   template <typename T>
   constexpr OutputSize operator+(OutputSize size, BinFormat<T> h) noexcept
   {
-    return {size.size + 8 * sizeof(T)};
+    if constexpr (same_as<T, Bytes>)
+      return {size.size + 8 * h.t.size()};
+    else
+      return {size.size + 8 * sizeof(T)};
   }
 
   template <typename T>
@@ -294,6 +872,328 @@ namespace lib
   {
     return BinFormat<T>{t};
   }
+
+  constexpr BinFormat<Bytes> bin(Bytes bytes)
+  {
+    return BinFormat<Bytes>{bytes};
+  }
+
+  struct Base64Format
+  {
+    Bytes t;
+  };
+
+  template <Output OUT>
+  constexpr OUT &operator<<(OUT &buff, Base64Format b) noexcept
+  {
+    return encoded<192, 256>(
+        buff, b.t.begin(), b.t.size(),
+        [](const unsigned char *p, Size n, char *d)
+        { encoding::base64(p, n, d); },
+        [](Size n)
+        { return encoding::base64_size(n); });
+  }
+
+  constexpr OutputSize operator+(OutputSize size, Base64Format b) noexcept
+  {
+    return {size.size + encoding::base64_size(b.t.size())};
+  }
+
+  // Standard padded base64 of bytes.
+  constexpr Base64Format base64(Bytes bytes)
+  {
+    return Base64Format{bytes};
+  }
+
+  struct Unbase64Format
+  {
+    StringView s;
+  };
+
+  template <Output OUT>
+  constexpr OUT &operator<<(OUT &buff, Unbase64Format u) noexcept
+  {
+    const char *s = u.s.begin();
+    Size n = u.s.size();
+    Size sz = encoding::unbase64_size(s, n);
+
+    if constexpr (ReservableOutput<OUT>)
+      if (char *d = buff.reserve(sz); d != nullptr)
+      {
+        auto *p = reinterpret_cast<unsigned char *>(d);
+
+        if (encoding::unbase64(s, n, p) == sz)
+          buff.commit(sz);
+
+        return buff;
+      }
+
+    unsigned char tmp[192];
+
+    if (!encoding::isbase64(s, n))
+      return buff;
+
+    for (Size k; n != 0; s += k, n -= k)
+    {
+      k = n < 256 ? n : 256;
+      Size m = encoding::unbase64(s, k, tmp);
+      buff << StringView(reinterpret_cast<const char *>(tmp), m);
+    }
+
+    return buff;
+  }
+
+  // Nothing is written for invalid input, so nothing counted.
+  constexpr OutputSize operator+(OutputSize size, Unbase64Format u) noexcept
+  {
+    if (!encoding::isbase64(u.s.begin(), u.s.size()))
+      return size;
+
+    return {size.size + encoding::unbase64_size(u.s.begin(), u.s.size())};
+  }
+
+  // Bytes decoded from padded base64, nothing when
+  // s is not valid base64.
+  constexpr Unbase64Format unbase64(StringView s)
+  {
+    return Unbase64Format{s};
+  }
+
+  template <Output OUT>
+  constexpr OUT &zeros(OUT &buff, Size n) noexcept
+  {
+    constexpr StringView z = "0000000000000000";
+
+    for (; n > z.size(); n -= z.size())
+      buff << z;
+
+    return buff << StringView(z.begin(), n);
+  }
+
+  template <IsFloating T>
+  constexpr StringView nonfinite(T t) noexcept
+  {
+    if (__builtin_isnan(t))
+      return sv("nan");
+    else
+      return __builtin_signbit(t) ? sv("-inf") : sv("inf");
+  }
+
+  // Shortest digits rounding back to t, laid out as in
+  // JavaScript : plain notation up to 21 integer digits
+  // or 6 leading zeros, exponent notation beyond.
+  template <IsFloating T>
+  constexpr Size formatg(char *p, T t) noexcept
+  {
+    char *b = p;
+
+    if (!__builtin_isfinite(t))
+    {
+      StringView s = nonfinite(t);
+      std::memcpy(p, s.begin(), s.size());
+      return s.size();
+    }
+
+    if (__builtin_signbit(t))
+      *p++ = '-';
+
+    floating::Decimal d = floating::shortest(t);
+    Size n = digits10(d.digits);
+    int pt = int(n) + d.exponent;
+    char digits[20];
+
+    format10(digits, d.digits, n);
+
+    if (int(n) <= pt && pt <= 21)
+    {
+      std::memcpy(p, digits, n);
+      std::memset(p + n, '0', Size(pt) - n);
+      p += pt;
+    }
+    else if (0 < pt && pt <= 21)
+    {
+      std::memcpy(p, digits, Size(pt));
+      p[pt] = '.';
+      std::memcpy(p + pt + 1, digits + pt, n - Size(pt));
+      p += n + 1;
+    }
+    else if (-6 < pt && pt <= 0)
+    {
+      *p++ = '0';
+      *p++ = '.';
+      std::memset(p, '0', Size(-pt));
+      std::memcpy(p - pt, digits, n);
+      p += n - pt;
+    }
+    else
+    {
+      *p++ = digits[0];
+
+      if (n > 1)
+      {
+        *p++ = '.';
+        std::memcpy(p, digits + 1, n - 1);
+        p += n - 1;
+      }
+
+      *p++ = 'e';
+      *p++ = pt > 0 ? '+' : '-';
+
+      Size e = Size(pt > 0 ? pt - 1 : 1 - pt);
+      Size en = digits10(e);
+      format10(p, e, en);
+      p += en;
+    }
+
+    return Size(p - b);
+  }
+
+  template <Output OUT, IsFloating T>
+  constexpr OUT &operator<<(OUT &buff, T t) noexcept
+  {
+    char tmp[32];
+    return buff << StringView(tmp, formatg(tmp, t));
+  }
+
+  template <IsFloating T>
+  constexpr OutputSize operator+(OutputSize size, T t) noexcept
+  {
+    char tmp[32];
+    return {size.size + formatg(tmp, t)};
+  }
+
+  template <typename T>
+  struct FixedFormat
+  {
+    const T &t;
+    int precision;
+  };
+
+  template <Output OUT, typename T>
+  constexpr OUT &operator<<(OUT &buff, FixedFormat<T> f) noexcept
+  {
+    if (!__builtin_isfinite(f.t))
+      return buff << nonfinite(f.t);
+
+    floating::Digits ds;
+    floating::rounded(double(f.t), f.precision, true, ds);
+
+    Size n = ds.n;
+    Size p = Size(f.precision);
+    Size ipart = ds.pt > 0 ? Size(ds.pt) : 0;
+
+    if (__builtin_signbit(f.t))
+      buff << '-';
+
+    if (ipart == 0)
+      buff << '0';
+    else
+    {
+      Size k = n < ipart ? n : ipart;
+      zeros(buff << StringView(ds.d, k), ipart - k);
+    }
+
+    if (p != 0)
+    {
+      Size lead = ds.pt < 0 ? Size(-ds.pt) : 0;
+      lead = lead < p ? lead : p;
+
+      Size k = n > ipart ? n - ipart : 0;
+      k = k < p - lead ? k : p - lead;
+
+      buff << '.';
+      zeros(buff, lead) << StringView(ds.d + ipart, k);
+      zeros(buff, p - lead - k);
+    }
+
+    return buff;
+  }
+
+  template <typename T>
+  constexpr OutputSize operator+(OutputSize size, FixedFormat<T> f) noexcept
+  {
+    if (!__builtin_isfinite(f.t))
+      return {size.size + nonfinite(f.t).size()};
+
+    floating::Digits ds;
+    floating::rounded(double(f.t), f.precision, true, ds);
+
+    return {size.size +
+            (__builtin_signbit(f.t) ? 1 : 0) +
+            (ds.pt > 0 ? Size(ds.pt) : 1) +
+            (f.precision > 0 ? Size(f.precision) + 1 : 0)};
+  }
+
+  // Fixed notation with precision digits after the point,
+  // correctly rounded (as printf("%.*f")).
+  template <IsFloating T>
+  constexpr FixedFormat<T> fixed(const T &t, int precision = 6)
+  {
+    return FixedFormat<T>{t, precision < 0 ? 0 : precision};
+  }
+
+  template <typename T>
+  struct ScientificFormat
+  {
+    const T &t;
+    int precision;
+  };
+
+  template <Output OUT, typename T>
+  constexpr OUT &operator<<(OUT &buff, ScientificFormat<T> f) noexcept
+  {
+    if (!__builtin_isfinite(f.t))
+      return buff << nonfinite(f.t);
+
+    floating::Digits ds;
+    floating::rounded(double(f.t), f.precision, false, ds);
+
+    Size n = ds.n;
+    Size p = Size(f.precision);
+
+    if (__builtin_signbit(f.t))
+      buff << '-';
+
+    buff << ds.d[0];
+
+    if (p != 0)
+      zeros(buff << '.' << StringView(ds.d + 1, n - 1), p - (n - 1));
+
+    int e = ds.pt - 1;
+
+    buff << 'e' << (e < 0 ? '-' : '+');
+
+    if (e > -10 && e < 10)
+      buff << '0';
+
+    return buff << (e < 0 ? -e : e);
+  }
+
+  template <typename T>
+  constexpr OutputSize operator+(OutputSize size, ScientificFormat<T> f) noexcept
+  {
+    if (!__builtin_isfinite(f.t))
+      return {size.size + nonfinite(f.t).size()};
+
+    floating::Digits ds;
+    floating::rounded(double(f.t), f.precision, false, ds);
+
+    int e = ds.pt - 1;
+    Size en = digits10(Size(e < 0 ? -e : e));
+
+    return {size.size +
+            (__builtin_signbit(f.t) ? 1 : 0) + 1 +
+            (f.precision > 0 ? Size(f.precision) + 1 : 0) +
+            2 + (en < 2 ? 2 : en)};
+  }
+
+  // Scientific notation with precision digits after the
+  // point, correctly rounded (as printf("%.*e")).
+  template <IsFloating T>
+  constexpr ScientificFormat<T> scientific(const T &t, int precision = 6)
+  {
+    return ScientificFormat<T>{t, precision < 0 ? 0 : precision};
+  }
 }
 
 #endif
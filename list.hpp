@@ -5,10 +5,11 @@
 #include <lib/basic_types.hpp>
 #include <lib/vector.hpp>
 #include <lib/range.hpp>
+#include <lib/allocator.hpp>
 
 namespace lib
 {
-  template <typename T>
+  template <typename T, Allocator A = HeapAllocator>
   class List
   {
     struct Node
@@ -20,11 +21,11 @@ namespace lib
 
     Size first = Size(-1);
     Size last = Size(-1);
-    Vector<Node> storage;
+    Vector<Node, A> storage;
 
     struct Iterator
     {
-      List<T> &l;
+      List &l;
       Size cur = Size(-1);
 
       constexpr Iterator &operator++() noexcept
@@ -79,7 +80,7 @@ namespace lib
 
     struct ConstIterator
     {
-      const List<T> &l;
+      const List &l;
       Size cur = Size(-1);
 
       constexpr bool operator==(const ConstIterator &o) const noexcept
@@ -143,14 +144,19 @@ namespace lib
   public:
     constexpr List() noexcept = default;
 
-    constexpr List(Size _max) noexcept
-        : storage(_max)
+    explicit constexpr List(A a) noexcept
+        : storage(a)
+    {
+    }
+
+    constexpr List(Size _max, A a = A()) noexcept
+        : storage(_max, a)
     {
     }
 
     template <typename IT>
-    constexpr List(IT b, IT e) noexcept
-        : List()
+    constexpr List(IT b, IT e, A a = A()) noexcept
+        : List(a)
     {
       append(b, e);
     }
@@ -188,6 +194,11 @@ namespace lib
       return storage.empty();
     }
 
+    constexpr A allocator() const noexcept
+    {
+      return storage.allocator();
+    }
+
   public:
     constexpr void insert(Iterator it, const T &t) noexcept
     {
@@ -1,13 +1,79 @@
 #ifndef __log_logger_hpp__
 #define __log_logger_hpp__
 
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
 #include <lib/string.hpp>
 #include <lib/array.hpp>
+#include <lib/vector.hpp>
 #include <lib/iostream.hpp>
+#include <lib/format.hpp>
+#include <lib/clock.hpp>
 #include <lib/utility.hpp>
 
+// Lowest level compiled in, from 0 (trace) to 5 (fatal).
+#ifndef LIB_LOG_LEVEL
+#define LIB_LOG_LEVEL 0
+#endif
+
+// Unlike the functions, these do not evaluate their
+// arguments when the level is disabled.
+#define LIB_LOG(l, ...)                                  \
+  do                                                     \
+  {                                                      \
+    if constexpr (::lib::logger::compiled_in(l))         \
+      if (::lib::logger::enabled(l))                     \
+        ::lib::logger::log(l, __VA_ARGS__);              \
+  } while (false)
+
+#define LIB_TRACE(...) LIB_LOG(::lib::logger::level::trace, __VA_ARGS__)
+#define LIB_DEBUG(...) LIB_LOG(::lib::logger::level::debug, __VA_ARGS__)
+#define LIB_INFO(...) LIB_LOG(::lib::logger::level::info, __VA_ARGS__)
+#define LIB_WARN(...) LIB_LOG(::lib::logger::level::warn, __VA_ARGS__)
+#define LIB_ERROR(...) LIB_LOG(::lib::logger::level::error, __VA_ARGS__)
+#define LIB_FATAL(...) LIB_LOG(::lib::logger::level::fatal, __VA_ARGS__)
+
+#define LIB_LOG_STRING_(x) #x
+#define LIB_LOG_STRING(x) LIB_LOG_STRING_(x)
+
+// Call sites keeping their own limiter, named by their
+// file and line : the arguments are only evaluated for
+// the lines that pass it.
+#define LIB_LIMITED(limiter, param, l, ...)                                   \
+  do                                                                          \
+  {                                                                           \
+    if constexpr (::lib::logger::compiled_in(l))                              \
+    {                                                                         \
+      static ::lib::logger::limiter site_(                                    \
+          ::lib::logger::where(__FILE__ ":" LIB_LOG_STRING(__LINE__)));       \
+      ::lib::Size suppressed_;                                                \
+                                                                              \
+      if (::lib::logger::enabled(l) && site_.pass(param, l, suppressed_))     \
+        ::lib::logger::log(l, __VA_ARGS__,                                    \
+                           ::lib::logger::Suppressed{suppressed_});           \
+    }                                                                         \
+  } while (false)
+
+#define LIB_EVERY_N(n, l, ...) LIB_LIMITED(EveryN, n, l, __VA_ARGS__)
+#define LIB_AT_MOST_PER_SECOND(k, l, ...) LIB_LIMITED(PerSecond, k, l, __VA_ARGS__)
+#define LIB_SAMPLED(p, l, ...) LIB_LIMITED(Sampled, p, l, __VA_ARGS__)
+
+#define LIB_RECORD(l, f, ...)                                 \
+  do                                                          \
+  {                                                           \
+    if constexpr (::lib::logger::compiled_in(l))              \
+      if (::lib::logger::enabled(l))                          \
+        ::lib::logger::record<f>(l __VA_OPT__(, ) __VA_ARGS__); \
+  } while (false)
+
 namespace lib::logger
 {
+  // The overloads below would hide those of lib.
+  using lib::operator<<;
+  using lib::operator+;
+
   enum class level : int
   {
     trace = 0,
@@ -27,44 +93,1284 @@ namespace lib::logger
     return buff << ltable[(int)l];
   }
 
-  constexpr OutputSize operator+(OutputSize size, level) noexcept
+  constexpr OutputSize operator+(OutputSize size, level l) noexcept
+  {
+    constexpr Size lsizes[] = {5, 5, 4, 4, 5, 5};
+    return {size.size + lsizes[(int)l]};
+  }
+
+  // What a thread does when its ring is full.
+  enum class overflow : int
+  {
+    block = 0,
+    drop = 1,
+    count = 2
+  };
+
+  // Stamps are clock::wall() nanoseconds.
+  inline unsigned long long now() noexcept
+  {
+    return clock::wall();
+  }
+
+  inline bool timestamps = true;
+
+  // Whether lines start with their ISO-8601 time.
+  inline void set_timestamps(bool on) noexcept
+  {
+    __atomic_store_n(&timestamps, on, __ATOMIC_RELAXED);
+  }
+
+  // Start of a text line : "<time> <level> : ".
+  struct Prefix
+  {
+    unsigned long long stamp;
+    level l;
+    bool stamped = __atomic_load_n(&timestamps, __ATOMIC_RELAXED);
+  };
+
+  template <Output OUT>
+  constexpr OUT &operator<<(OUT &buff, Prefix p) noexcept
+  {
+    if (p.stamped)
+      buff << clock::iso8601(p.stamp) << ' ';
+
+    return buff << p.l << " : ";
+  }
+
+  constexpr OutputSize operator+(OutputSize size, Prefix p) noexcept
+  {
+    if (p.stamped)
+      size = size + clock::iso8601(p.stamp) + ' ';
+
+    return size + p.l + " : ";
+  }
+
+  inline void pause(unsigned &spins) noexcept
+  {
+    if (spins < 64)
+      ::sched_yield();
+    else
+    {
+      ::timespec ts{0, spins < 1024 ? 50000 : 1000000};
+      ::nanosleep(&ts, nullptr);
+    }
+
+    ++spins;
+  }
+
+  // Single producer single consumer ring of records, each a
+  // header and the formatted line, 16 bytes aligned. A record
+  // never wraps : the end of the storage is skipped by a
+  // padding header when it is too short.
+  class Ring
+  {
+  public:
+    struct Header
+    {
+      unsigned long long stamp;
+      Size size;
+    };
+
+    static constexpr Size hsize = sizeof(Header);
+    static constexpr Size padding = Size(-1);
+
+    static constexpr Size aligned(Size n) noexcept
+    {
+      return (n + 15) & ~Size(15);
+    }
+
+  private:
+    // Writes the formatted line in place, cutting
+    // what does not fit in the record.
+    struct RecordOutput
+    {
+      char *p;
+      Size max;
+      Size lgth = 0;
+
+      char *reserve(Size n) noexcept
+      {
+        return n <= max - lgth ? p + lgth : nullptr;
+      }
+
+      void commit(Size n) noexcept
+      {
+        lgth += n;
+      }
+
+      void append(char c) noexcept
+      {
+        if (lgth < max)
+          p[lgth++] = c;
+      }
+
+      void append(StringView sv) noexcept
+      {
+        Size n = sv.size() < max - lgth ? sv.size() : max - lgth;
+
+        if (n != 0)
+          std::memcpy(p + lgth, sv.begin(), n);
+
+        lgth += n;
+      }
+    };
+
+    Size max;
+    Strong<char[]> buff;
+    alignas(64) Size tail = 0;
+    alignas(64) Size head = 0;
+    alignas(64) Size dropped = 0;
+    bool retired = false;
+
+  public:
+    explicit Ring(Size _max) noexcept
+        : max(_max),
+          buff(Strong<char[]>::allocate(max))
+    {
+    }
+
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+  private:
+    char *at(Size pos) noexcept
+    {
+      return static_cast<char *>(buff) + (pos & (max - 1));
+    }
+
+  public:
+    // Producer side. Lines longer than half the ring are
+    // cut, keeping their final '\n'.
+    template <typename... Args>
+    bool push(overflow policy, unsigned long long stamp, const Args &...args) noexcept
+    {
+      Size full = (OutputSize() + ... + args).size;
+      Size limit = max / 2 - hsize;
+      Size n = full < limit ? full : limit;
+
+      Size t = tail;
+      Size contiguous = max - (t & (max - 1));
+      Size pad = aligned(hsize + n) > contiguous ? contiguous : 0;
+      Size need = pad + aligned(hsize + n);
+
+      for (unsigned spins = 0;
+           max - (t - __atomic_load_n(&head, __ATOMIC_ACQUIRE)) < need;)
+      {
+        if (policy != overflow::block)
+        {
+          drop();
+          return false;
+        }
+
+        pause(spins);
+      }
+
+      if (pad != 0)
+      {
+        Header h{stamp, padding};
+        std::memcpy(at(t), &h, hsize);
+        t += pad;
+      }
+
+      RecordOutput out{at(t) + hsize, n};
+      (out << ... << args);
+
+      if (full > n)
+        out.p[n - 1] = '\n';
+
+      Header h{stamp, out.lgth};
+      std::memcpy(at(t), &h, hsize);
+      __atomic_store_n(&tail, t + aligned(hsize + out.lgth), __ATOMIC_RELEASE);
+      return true;
+    }
+
+    // Longest line kept whole.
+    Size limit() const noexcept
+    {
+      return max / 2 - hsize;
+    }
+
+    void drop() noexcept
+    {
+      __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+    }
+
+    void retire() noexcept
+    {
+      __atomic_store_n(&retired, true, __ATOMIC_RELEASE);
+    }
+
+    // Consumer side.
+    bool front(Header &h, StringView &line) noexcept
+    {
+      while (true)
+      {
+        Size t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+
+        if (head == t)
+          return false;
+
+        std::memcpy(&h, at(head), hsize);
+
+        if (h.size != padding)
+        {
+          line = StringView(at(head) + hsize, h.size);
+          return true;
+        }
+
+        __atomic_store_n(&head, head + (max - (head & (max - 1))), __ATOMIC_RELEASE);
+      }
+    }
+
+    void pop(const Header &h) noexcept
+    {
+      __atomic_store_n(&head, head + aligned(hsize + h.size), __ATOMIC_RELEASE);
+    }
+
+    Size drops() noexcept
+    {
+      return __atomic_exchange_n(&dropped, 0, __ATOMIC_RELAXED);
+    }
+
+    bool done() noexcept
+    {
+      return __atomic_load_n(&retired, __ATOMIC_ACQUIRE) &&
+             head == __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    }
+  };
+
+  // Binary records : a tag, the u32 size of the body, then
+  // the body, in native byte order.
+  //  'D' definition : u32 site, u8 count of arguments, a kind
+  //      and a size byte per argument, the format string.
+  //  'E' event : u32 site, u8 level, u64 stamp, the arguments,
+  //      raw for scalars, u32 length and chars for strings.
+  //  'T' text : u8 level, u64 stamp, the formatted line.
+  enum class mode : int
+  {
+    text = 0,
+    binary = 1
+  };
+
+  template <typename T>
+  struct Raw
+  {
+    const T &t;
+  };
+
+  template <typename T>
+  constexpr Raw<T> raw(const T &t) noexcept
+  {
+    return Raw<T>{t};
+  }
+
+  template <Output OUT, typename T>
+  constexpr OUT &operator<<(OUT &buff, Raw<T> r) noexcept
+  {
+    buff.append(StringView(reinterpret_cast<const char *>(&r.t), sizeof(T)));
+    return buff;
+  }
+
+  template <typename T>
+  constexpr OutputSize operator+(OutputSize size, Raw<T>) noexcept
+  {
+    return {size.size + sizeof(T)};
+  }
+
+  template <typename T>
+  constexpr char kind() noexcept
+  {
+    using U = RemoveConstVolatile<T>;
+
+    if constexpr (IsBoolean<U>)
+      return 'b';
+    else if constexpr (same_as<U, char>)
+      return 'c';
+    else if constexpr (IsSignedInteger<U>)
+      return 'i';
+    else if constexpr (IsUnsignedInteger<U>)
+      return 'u';
+    else if constexpr (IsFloating<U>)
+      return 'f';
+    else
+    {
+      static_assert(Viewable<const T &>,
+                    "binary logging takes scalars and strings only");
+      return 's';
+    }
+  }
+
+  template <typename T>
+  struct Encoded
+  {
+    const T &t;
+  };
+
+  template <Output OUT, typename T>
+  constexpr OUT &operator<<(OUT &buff, Encoded<T> e) noexcept
+  {
+    if constexpr (kind<T>() == 's')
+    {
+      StringView v(e.t);
+      unsigned n = unsigned(v.size());
+      buff << raw(n);
+      buff.append(v);
+      return buff;
+    }
+    else
+      return buff << raw(e.t);
+  }
+
+  template <typename T>
+  constexpr OutputSize operator+(OutputSize size, Encoded<T> e) noexcept
+  {
+    if constexpr (kind<T>() == 's')
+      return {size.size + 4 + StringView(e.t).size()};
+    else
+      return {size.size + sizeof(T)};
+  }
+
+  inline unsigned sites = 0;
+
+  // A format string and the types of its arguments, numbered
+  // on first use and defined once per Async it is logged to.
+  template <FormatString F, typename... Args>
+  struct Site
+  {
+    static constexpr char kinds[] = {kind<Args>()..., 0};
+    static constexpr unsigned char sizes[] = {
+        (unsigned char)(kind<Args>() == 's' ? 0 : sizeof(Args))..., 0};
+
+    static inline unsigned long long defined = 0;
+
+    static unsigned id() noexcept
+    {
+      static const unsigned i = __atomic_add_fetch(&sites, 1, __ATOMIC_RELAXED);
+      return i;
+    }
+  };
+
+  template <typename S>
+  struct Definition
+  {
+  };
+
+  template <Output OUT, FormatString F, typename... Args>
+  constexpr OUT &operator<<(OUT &buff, Definition<Site<F, Args...>>) noexcept
+  {
+    using S = Site<F, Args...>;
+
+    buff << raw(S::id()) << raw((unsigned char)(sizeof...(Args)));
+
+    for (Size i = 0; i < sizeof...(Args); ++i)
+      buff << S::kinds[i] << (char)(S::sizes[i]);
+
+    buff.append(StringView(F.s, sizeof(F.s) - 1));
+    return buff;
+  }
+
+  template <FormatString F, typename... Args>
+  constexpr OutputSize operator+(OutputSize size, Definition<Site<F, Args...>>) noexcept
+  {
+    return {size.size + 5 + 2 * sizeof...(Args) + sizeof(F.s) - 1};
+  }
+
+  class Async;
+
+  inline void flush_suppressed() noexcept;
+
+  struct Registry
+  {
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    Async *active = nullptr;
+    unsigned long long generation = 0;
+  };
+
+  inline Registry registry;
+
+  // Ring of the calling thread, retired when it exits.
+  struct Local
+  {
+    unsigned long long generation = 0;
+    Ring *ring = nullptr;
+
+    ~Local() noexcept;
+  };
+
+  inline thread_local Local local;
+
+  // Asynchronous mode of the logger, active while this object
+  // lives : each thread formats its lines into its own ring
+  // and a background thread writes them, in timestamp order,
+  // to a BufferedOutput on fd. Threads must stop logging
+  // before it is destroyed. When a ring is full the line is
+  // waited for, dropped, or dropped and counted in a summary
+  // line, according to policy.
+  class Async
+  {
+    Size ringsize;
+    overflow policy;
+    mode encoding;
+    unsigned long long generation;
+    BufferedOutput sink;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    Vector<Ring *> rings;
+    Size changes = 0;
+    Vector<Ring *> drained;
+    Size seen = 0;
+    pthread_t drainer;
+    bool running = true;
+
+  public:
+    explicit Async(int fd = 1, Size _ringsize = 64 * 1024,
+                   overflow _policy = overflow::block,
+                   mode _encoding = mode::text) noexcept
+        : ringsize(_ringsize < 256 ? 256 : _ringsize),
+          policy(_policy),
+          encoding(_encoding),
+          sink(fd)
+    {
+      while ((ringsize & (ringsize - 1)) != 0)
+        ringsize &= ringsize - 1;
+
+      ::pthread_create(&drainer, nullptr, &Async::run, this);
+
+      ::pthread_mutex_lock(&registry.lock);
+      generation = ++registry.generation;
+      __atomic_store_n(&registry.active, this, __ATOMIC_RELEASE);
+      ::pthread_mutex_unlock(&registry.lock);
+    }
+
+    Async(const Async &) = delete;
+    Async &operator=(const Async &) = delete;
+
+    ~Async() noexcept
+    {
+      flush_suppressed();
+
+      ::pthread_mutex_lock(&registry.lock);
+      __atomic_store_n(&registry.active, nullptr, __ATOMIC_RELEASE);
+      ::pthread_mutex_unlock(&registry.lock);
+
+      __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+      ::pthread_join(drainer, nullptr);
+
+      for (Ring *r : rings)
+        delete r;
+    }
+
+  private:
+    static void *run(void *self) noexcept
+    {
+      static_cast<Async *>(self)->drain();
+      return nullptr;
+    }
+
+    // Copies rings into drained, in place and only when a
+    // ring was added or removed since the last copy.
+    void snapshot() noexcept
+    {
+      if (__atomic_load_n(&changes, __ATOMIC_ACQUIRE) == seen)
+        return;
+
+      ::pthread_mutex_lock(&lock);
+      drained.clear();
+      drained.append(rings);
+      seen = changes;
+      ::pthread_mutex_unlock(&lock);
+    }
+
+    // Deletes the rings of exited threads. Rebuilds rings
+    // only when there are some, which is rare.
+    void collect() noexcept
+    {
+      ::pthread_mutex_lock(&lock);
+      Size ndone = 0;
+
+      for (Ring *r : rings)
+        if (r->done())
+          ++ndone;
+
+      if (ndone != 0)
+      {
+        Vector<Ring *> kept(rings.size() - ndone);
+
+        for (Ring *r : rings)
+          if (r->done())
+            delete r;
+          else
+            kept.push_back(r);
+
+        rings = move(kept);
+        __atomic_store_n(&changes, changes + 1, __ATOMIC_RELEASE);
+      }
+
+      ::pthread_mutex_unlock(&lock);
+    }
+
+    // Writes the lines ready in all rings, oldest first.
+    Size flush(Vector<Ring *> &rs) noexcept
+    {
+      Size written = 0;
+      Ring::Header h, hmin;
+      StringView line, lmin;
+
+      while (true)
+      {
+        Ring *rmin = nullptr;
+
+        for (Ring *r : rs)
+          if (r->front(h, line) && (rmin == nullptr || h.stamp < hmin.stamp))
+          {
+            rmin = r;
+            hmin = h;
+            lmin = line;
+          }
+
+        if (rmin == nullptr)
+          break;
+
+        sink << lmin;
+        rmin->pop(hmin);
+        ++written;
+      }
+
+      Size drops = 0;
+
+      for (Ring *r : rs)
+        drops += r->drops();
+
+      if (drops != 0 && policy == overflow::count)
+      {
+        if (encoding == mode::binary)
+        {
+          unsigned long long stamp = now();
+          unsigned size = unsigned(
+              9 + (OutputSize() + "logger dropped " + drops + " lines").size);
+
+          sink << 'T' << raw(size) << raw((unsigned char)(level::warn))
+               << raw(stamp) << "logger dropped " << drops << " lines";
+        }
+        else
+          sink << Prefix{now(), level::warn}
+               << "logger dropped " << drops << " lines\n";
+      }
+
+      return written;
+    }
+
+    void drain() noexcept
+    {
+      unsigned spins = 0;
+
+      while (true)
+      {
+        bool stop = !__atomic_load_n(&running, __ATOMIC_ACQUIRE);
+        snapshot();
+
+        if (flush(drained) != 0)
+        {
+          spins = 0;
+          continue;
+        }
+
+        sink.flush();
+
+        if (stop)
+          return;
+
+        collect();
+        pause(spins);
+      }
+    }
+
+  public:
+    Ring *ring() noexcept
+    {
+      if (local.generation != generation)
+      {
+        Ring *r = new Ring(ringsize);
+
+        ::pthread_mutex_lock(&lock);
+        rings.push_back(r);
+        __atomic_store_n(&changes, changes + 1, __ATOMIC_RELEASE);
+        ::pthread_mutex_unlock(&lock);
+
+        local.generation = generation;
+        local.ring = r;
+      }
+
+      return local.ring;
+    }
+
+    template <typename... Args>
+    bool push(unsigned long long stamp, const Args &...args) noexcept
+    {
+      Ring *r = ring();
+
+      // A cut binary record would garble the records after it.
+      if (encoding == mode::binary &&
+          (OutputSize() + ... + args).size > r->limit())
+      {
+        r->drop();
+        return false;
+      }
+
+      return r->push(policy, stamp, args...);
+    }
+
+    template <typename... Args>
+    void text(level l, const Args &...args) noexcept
+    {
+      unsigned long long stamp = now();
+
+      if (encoding == mode::text)
+        push(stamp, Prefix{stamp, l}, args..., '\n');
+      else
+      {
+        unsigned size = unsigned(9 + (OutputSize() + ... + args).size);
+        push(stamp, 'T', raw(size), raw((unsigned char)(l)), raw(stamp), args...);
+      }
+    }
+
+    template <FormatString F, typename... Args>
+    void event(level l, const Args &...args) noexcept
+    {
+      using S = Site<F, Args...>;
+
+      if (__atomic_load_n(&S::defined, __ATOMIC_RELAXED) != generation)
+      {
+        Definition<S> d;
+        unsigned size = unsigned((OutputSize() + d).size);
+
+        if (!push(now(), 'D', raw(size), d))
+          return;
+
+        __atomic_store_n(&S::defined, generation, __ATOMIC_RELAXED);
+      }
+
+      unsigned long long stamp = now();
+      unsigned id = S::id();
+      unsigned size = unsigned(13 + (OutputSize() + ... + Encoded<Args>{args}).size);
+
+      push(stamp, 'E', raw(size), raw(id), raw((unsigned char)(l)), raw(stamp),
+           Encoded<Args>{args}...);
+    }
+
+    bool binary() const noexcept
+    {
+      return encoding == mode::binary;
+    }
+
+    unsigned long long id() const noexcept
+    {
+      return generation;
+    }
+  };
+
+  inline Local::~Local() noexcept
+  {
+    ::pthread_mutex_lock(&registry.lock);
+    Async *a = registry.active;
+
+    if (a != nullptr && a->id() == generation && ring != nullptr)
+      ring->retire();
+
+    ::pthread_mutex_unlock(&registry.lock);
+  }
+
+  // Lowest level compiled in. Calls through the LIB_LOG
+  // macros below it vanish with their arguments.
+  constexpr level compiled = level(LIB_LOG_LEVEL);
+
+  // Lowest level written, checked before any formatting.
+  inline int threshold = 0;
+
+  inline void set_threshold(level l) noexcept
+  {
+    __atomic_store_n(&threshold, (int)l, __ATOMIC_RELAXED);
+  }
+
+  constexpr bool compiled_in(level l) noexcept
+  {
+    return l >= compiled;
+  }
+
+  inline bool enabled(level l) noexcept
   {
-    return {size.size + 5};
+    return compiled_in(l) &&
+           (int)l >= __atomic_load_n(&threshold, __ATOMIC_RELAXED);
+  }
+
+  // Argument produced by f only when its line is written,
+  // once even if it is both sized and written.
+  template <typename F>
+  class Lazy
+  {
+    F f;
+    mutable decltype(f()) value{};
+    mutable bool done = false;
+
+  public:
+    explicit constexpr Lazy(F _f) noexcept
+        : f(_f)
+    {
+    }
+
+    constexpr const auto &get() const noexcept
+    {
+      if (!done)
+      {
+        value = f();
+        done = true;
+      }
+
+      return value;
+    }
+  };
+
+  template <typename F>
+  constexpr Lazy<F> lazy(F f) noexcept
+  {
+    return Lazy<F>(f);
+  }
+
+  template <Output OUT, typename F>
+  constexpr OUT &operator<<(OUT &buff, const Lazy<F> &l) noexcept
+  {
+    return buff << l.get();
+  }
+
+  template <typename F>
+  constexpr OutputSize operator+(OutputSize size, const Lazy<F> &l) noexcept
+  {
+    return size + l.get();
   }
 
   inline void log(level l, const auto &...pms) noexcept
   {
-    println(l, " : ", pms...);
+    if (!enabled(l))
+      return;
+
+    if (Async *a = __atomic_load_n(&registry.active, __ATOMIC_ACQUIRE))
+      a->text(l, pms...);
+    else
+      println(Prefix{now(), l}, pms...);
+  }
+
+  // Count of lines a limiter held back since the last one
+  // it let through, written after that one when not zero.
+  struct Suppressed
+  {
+    Size n;
+  };
+
+  template <Output OUT>
+  constexpr OUT &operator<<(OUT &buff, Suppressed s) noexcept
+  {
+    if (s.n != 0)
+      buff << " (suppressed " << s.n << " messages)";
+
+    return buff;
+  }
+
+  constexpr OutputSize operator+(OutputSize size, Suppressed s) noexcept
+  {
+    if (s.n != 0)
+      size = size + " (suppressed " + s.n + " messages)";
+
+    return size;
+  }
+
+  template <Size N>
+  constexpr StringView where(const char (&s)[N]) noexcept
+  {
+    return StringView(s, N - 1);
+  }
+
+  // Limiters keep the state of one call site in relaxed
+  // atomics : pass() tells whether a line goes through and
+  // how many were held back before it. Under concurrent
+  // calls the counts are approximate, never blocking.
+  //
+  // A site holding lines back is linked, once, into a list
+  // that flush_suppressed() walks : the count held after
+  // the last line of a flood is reported there.
+  class Limiter
+  {
+    StringView name;
+    Size held = 0;
+    int l = 0;
+    bool listed = false;
+    Limiter *next = nullptr;
+
+    friend void flush_suppressed() noexcept;
+
+  protected:
+    void hold(level lv) noexcept;
+
+    Size release() noexcept
+    {
+      return __atomic_exchange_n(&held, 0, __ATOMIC_RELAXED);
+    }
+
+  public:
+    explicit constexpr Limiter(StringView _name) noexcept
+        : name(_name)
+    {
+    }
+
+    Limiter(const Limiter &) = delete;
+    Limiter &operator=(const Limiter &) = delete;
+  };
+
+  inline Limiter *limiters = nullptr;
+
+  inline void Limiter::hold(level lv) noexcept
+  {
+    __atomic_store_n(&l, (int)lv, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&held, 1, __ATOMIC_RELAXED);
+
+    if (!__atomic_load_n(&listed, __ATOMIC_RELAXED) &&
+        !__atomic_exchange_n(&listed, true, __ATOMIC_RELAXED))
+    {
+      next = __atomic_load_n(&limiters, __ATOMIC_RELAXED);
+
+      while (!__atomic_compare_exchange_n(&limiters, &next, this, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+    }
+  }
+
+  // Writes, for each site, the count of lines it held back
+  // since the last one it let through, as a line of its
+  // own : "<site> : suppressed N messages". Called when an
+  // Async ends and at exit.
+  inline void flush_suppressed() noexcept
+  {
+    for (Limiter *s = __atomic_load_n(&limiters, __ATOMIC_ACQUIRE);
+         s != nullptr; s = s->next)
+      if (Size n = s->release(); n != 0)
+        log(level(__atomic_load_n(&s->l, __ATOMIC_RELAXED)),
+            s->name, " : suppressed ", n, " messages");
+  }
+
+  struct FlushAtExit
+  {
+    ~FlushAtExit() noexcept
+    {
+      flush_suppressed();
+    }
+  };
+
+  inline FlushAtExit flush_at_exit;
+
+  // The first line, then one in n.
+  class EveryN : public Limiter
+  {
+    Size count = 0;
+
+  public:
+    using Limiter::Limiter;
+
+    bool pass(Size n, level l, Size &suppressed) noexcept
+    {
+      Size c = __atomic_fetch_add(&count, 1, __ATOMIC_RELAXED);
+
+      if (n > 1 && c % n != 0)
+      {
+        hold(l);
+        return false;
+      }
+
+      suppressed = release();
+      return true;
+    }
+  };
+
+  // At most k lines in each second of clock::coarse().
+  class PerSecond : public Limiter
+  {
+    unsigned long long window = 0;
+    Size count = 0;
+
+  public:
+    using Limiter::Limiter;
+
+    bool pass(Size k, level l, Size &suppressed) noexcept
+    {
+      unsigned long long sec = clock::coarse() / 1000000000;
+      unsigned long long w = __atomic_load_n(&window, __ATOMIC_RELAXED);
+
+      if (sec != w &&
+          __atomic_compare_exchange_n(&window, &w, sec, false,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        __atomic_store_n(&count, 0, __ATOMIC_RELAXED);
+
+      if (__atomic_fetch_add(&count, 1, __ATOMIC_RELAXED) >= k)
+      {
+        hold(l);
+        return false;
+      }
+
+      suppressed = release();
+      return true;
+    }
+  };
+
+  // Each line with probability p, drawn from a per thread
+  // xorshift generator.
+  class Sampled : public Limiter
+  {
+    static unsigned long long draw() noexcept
+    {
+      static thread_local unsigned long long x =
+          clock::monotonic() ^ (unsigned long long)(&x) ^ 0x9E3779B97F4A7C15ull;
+
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      return x;
+    }
+
+  public:
+    using Limiter::Limiter;
+
+    bool pass(double p, level l, Size &suppressed) noexcept
+    {
+      if (p < 1.0 && double(draw() >> 11) >= p * 9007199254740992.0)
+      {
+        hold(l);
+        return false;
+      }
+
+      suppressed = release();
+      return true;
+    }
+  };
+
+  template <typename L, typename P>
+  inline void limited(L &site, P param, level l, const auto &...pms) noexcept
+  {
+    Size suppressed;
+
+    if (enabled(l) && site.pass(param, l, suppressed))
+      log(l, pms..., Suppressed{suppressed});
+  }
+
+  // Name of the type T, as the compiler spells it.
+  template <typename T>
+  constexpr StringView tagname() noexcept
+  {
+    constexpr StringView f = where(__PRETTY_FUNCTION__);
+    Size b = 0;
+
+    while (b + 4 <= f.size() && !(f[b] == 'T' && f[b + 1] == ' ' &&
+                                  f[b + 2] == '=' && f[b + 3] == ' '))
+      ++b;
+
+    Size e = b += 4;
+
+    while (e < f.size() && f[e] != ';' && f[e] != ']')
+      ++e;
+
+    return b <= f.size() ? StringView(f.begin() + b, e - b) : f;
+  }
+
+  template <typename Tag, typename L>
+  inline L limiter(tagname<Tag>());
+
+  // Functions for a site named by a tag type, as in
+  // every_n<struct retry_failed>(100, level::error, ...) :
+  // each tag owns its limiter, whatever the arguments.
+  template <typename Tag>
+  inline void every_n(Size n, level l, const auto &...pms) noexcept
+  {
+    limited(limiter<Tag, EveryN>, n, l, pms...);
+  }
+
+  template <typename Tag>
+  inline void at_most_per_second(Size k, level l, const auto &...pms) noexcept
+  {
+    limited(limiter<Tag, PerSecond>, k, l, pms...);
+  }
+
+  template <typename Tag>
+  inline void sampled(double p, level l, const auto &...pms) noexcept
+  {
+    limited(limiter<Tag, Sampled>, p, l, pms...);
+  }
+
+  // Line of format F. In binary mode only the raw arguments
+  // are copied and decode() formats them later. Otherwise
+  // it is written as format<F>(args...).
+  template <FormatString F, typename... Args>
+  inline void record(level l, const Args &...args) noexcept
+  {
+    static_assert(F.nargs == sizeof...(Args),
+                  "format string and argument count differ");
+
+    if (!enabled(l))
+      return;
+
+    Async *a = __atomic_load_n(&registry.active, __ATOMIC_ACQUIRE);
+
+    if (a != nullptr && a->binary())
+      a->event<F>(l, args...);
+    else
+      log(l, format<F>(args...));
+  }
+
+  template <typename T>
+  inline T load(const char *p) noexcept
+  {
+    T t;
+    std::memcpy(&t, p, sizeof(T));
+    return t;
+  }
+
+  template <typename T, Output OUT>
+  inline void decoded(OUT &out, T t, FormatSpec spec) noexcept
+  {
+    if (spec.type == 'x')
+      out << hex(t);
+    else if (spec.type == 'b')
+      out << bin(t);
+    else if constexpr (IsFloating<T>)
+    {
+      if (spec.type == 'f')
+        out << fixed(t, spec.precision);
+      else if (spec.type == 'e')
+        out << scientific(t, spec.precision);
+      else
+        out << t;
+    }
+    else
+      out << t;
+  }
+
+  // Writes the argument of kind k and size n read at p
+  // (before end), gives the position after it or nullptr.
+  template <Output OUT>
+  inline const char *decoded(OUT &out, char k, Size n, const char *p,
+                             const char *end, FormatSpec spec) noexcept
+  {
+    if (k == 's')
+    {
+      if (end - p < 4)
+        return nullptr;
+
+      Size lgth = load<unsigned>(p);
+
+      if (Size(end - p - 4) < lgth)
+        return nullptr;
+
+      out << StringView(p + 4, lgth);
+      return p + 4 + lgth;
+    }
+
+    if (Size(end - p) < n)
+      return nullptr;
+
+    if (k == 'b' && n == 1)
+      decoded(out, *p != 0, spec);
+    else if (k == 'c' && n == 1)
+      decoded(out, *p, spec);
+    else if (k == 'i' && n == sizeof(short))
+      decoded(out, load<short>(p), spec);
+    else if (k == 'i' && n == sizeof(int))
+      decoded(out, load<int>(p), spec);
+    else if (k == 'i' && n == sizeof(long long))
+      decoded(out, load<long long>(p), spec);
+    else if (k == 'u' && n == sizeof(unsigned short))
+      decoded(out, load<unsigned short>(p), spec);
+    else if (k == 'u' && n == sizeof(unsigned))
+      decoded(out, load<unsigned>(p), spec);
+    else if (k == 'u' && n == sizeof(unsigned long long))
+      decoded(out, load<unsigned long long>(p), spec);
+    else if (k == 'f' && n == sizeof(float))
+      decoded(out, load<float>(p), spec);
+    else if (k == 'f' && n == sizeof(double))
+      decoded(out, load<double>(p), spec);
+    else
+      return nullptr;
+
+    return p + n;
+  }
+
+  // Renders the event body b with the definition d, as a
+  // line of the text mode.
+  template <Output OUT>
+  inline bool decoded(OUT &out, StringView d, StringView b) noexcept
+  {
+    Size nargs = (unsigned char)(d[4]);
+
+    if (b.size() < 13 || d.size() < 5 + 2 * nargs ||
+        (unsigned char)(b[4]) > (unsigned char)(level::fatal))
+      return false;
+
+    const char *types = d.begin() + 5;
+    const char *f = types + 2 * nargs;
+    const char *fend = d.end();
+    const char *p = b.begin() + 13;
+    Size arg = 0;
+
+    out << Prefix{load<unsigned long long>(b.begin() + 5), level((unsigned char)(b[4]))};
+
+    while (f != fend)
+    {
+      if ((*f == '{' || *f == '}') && f + 1 != fend && f[1] == *f)
+      {
+        out << *f;
+        f += 2;
+      }
+      else if (*f == '{')
+      {
+        FormatSpec spec;
+
+        if (++f != fend && *f == ':')
+          ++f;
+
+        if (f != fend && *f == '.')
+          for (spec.precision = 0; ++f != fend && isdigit(*f);)
+            spec.precision = spec.precision * 10 + (*f - '0');
+
+        if (f != fend && *f != '}')
+          spec.type = *f++;
+
+        if (f == fend || arg == nargs)
+          return false;
+
+        p = decoded(out, types[2 * arg], (unsigned char)(types[2 * arg + 1]),
+                    p, b.end(), spec);
+
+        if (p == nullptr)
+          return false;
+
+        ++arg;
+        ++f;
+      }
+      else
+        out << *f++;
+    }
+
+    out << '\n';
+    return true;
+  }
+
+  // Renders a binary log (as written by an Async in binary
+  // mode, for instance read through a MappedFile) as the
+  // text mode would have written it. Definitions are read
+  // first, so they may appear anywhere in the log. Gives
+  // false on a truncated or inconsistent log, after the
+  // lines preceding the fault.
+  template <Output OUT>
+  inline bool decode(StringView log, OUT &out) noexcept
+  {
+    Vector<StringView> defs;
+    Size whole = 0;
+
+    // Records up to whole are sound, a cut or corrupt one
+    // follows when whole is not the end of the log. Ids
+    // number the sites of the logging process, far fewer
+    // than the bytes of its log : a larger one is garbage,
+    // that would otherwise size defs.
+    while (log.size() - whole >= 5)
+    {
+      Size size = load<unsigned>(log.begin() + whole + 1);
+
+      if (log.size() - whole - 5 < size)
+        break;
+
+      StringView body(log.begin() + whole + 5, size);
+
+      if (log[whole] == 'D')
+      {
+        if (size < 5)
+          break;
+
+        Size id = load<unsigned>(body.begin());
+
+        if (id > log.size())
+          break;
+
+        while (defs.size() <= id)
+          defs.push_back(StringView());
+
+        defs[id] = body;
+      }
+
+      whole += 5 + size;
+    }
+
+    for (Size pos = 0; pos < whole;)
+    {
+      Size size = load<unsigned>(log.begin() + pos + 1);
+      StringView body(log.begin() + pos + 5, size);
+
+      if (log[pos] == 'T')
+      {
+        if (size < 9 || (unsigned char)(body[0]) > (unsigned char)(level::fatal))
+          return false;
+
+        out << Prefix{load<unsigned long long>(body.begin() + 1), level((unsigned char)(body[0]))}
+            << StringView(body.begin() + 9, size - 9) << '\n';
+      }
+      else if (log[pos] == 'E')
+      {
+        if (size < 13)
+          return false;
+
+        Size id = load<unsigned>(body.begin());
+
+        if (id >= defs.size() || defs[id].empty() ||
+            !decoded(out, defs[id], body))
+          return false;
+      }
+      else if (log[pos] != 'D')
+        return false;
+
+      pos += 5 + size;
+    }
+
+    return whole == log.size();
   }
 
   inline void trace(const auto &...pms) noexcept
   {
-    log(level::trace, pms...);
+    if constexpr (compiled_in(level::trace))
+      log(level::trace, pms...);
   }
 
   inline void debug(const auto &...pms) noexcept
   {
-    log(level::debug, pms...);
+    if constexpr (compiled_in(level::debug))
+      log(level::debug, pms...);
   }
 
   inline void info(const auto &...pms) noexcept
   {
-    log(level::info, pms...);
+    if constexpr (compiled_in(level::info))
+      log(level::info, pms...);
   }
 
   inline void warn(const auto &...pms) noexcept
   {
-    log(level::warn, pms...);
+    if constexpr (compiled_in(level::warn))
+      log(level::warn, pms...);
   }
 
   inline void error(const auto &...pms) noexcept
   {
-    log(level::error, pms...);
+    if constexpr (compiled_in(level::error))
+      log(level::error, pms...);
   }
 
   inline void fatal(const auto &...pms) noexcept
   {
-    log(level::fatal, pms...);
+    if constexpr (compiled_in(level::fatal))
+      log(level::fatal, pms...);
   }
 }
 
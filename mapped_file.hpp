@@ -0,0 +1,259 @@
+#ifndef __lib_mapped_file_hpp__
+#define __lib_mapped_file_hpp__
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <lib/basic_types.hpp>
+#include <lib/range.hpp>
+#include <lib/span.hpp>
+#include <lib/string.hpp>
+#include <lib/simd.hpp>
+
+namespace lib
+{
+  // Lines of a text as views into it, without their '\n',
+  // each one found when the iterator reaches it. A final
+  // '\n' does not start an empty line.
+  class Lines
+  {
+    StringView text;
+
+    struct Iterator
+    {
+      const char *cur;
+      const char *nl;
+      const char *last;
+
+      constexpr Iterator(const char *_cur, const char *_last) noexcept
+          : cur(_cur), nl(_cur), last(_last)
+      {
+        if (cur != last)
+          nl = simd::find(cur, last, '\n');
+      }
+
+      constexpr Iterator &operator++() noexcept
+      {
+        cur = nl == last ? last : nl + 1;
+        nl = cur == last ? last : simd::find(cur, last, '\n');
+        return *this;
+      }
+
+      constexpr Iterator operator++(int) noexcept
+      {
+        auto tmp = *this;
+        ++(*this);
+        return tmp;
+      }
+
+      constexpr bool operator==(const Iterator &o) const noexcept
+      {
+        return cur == o.cur;
+      }
+
+      constexpr bool operator!=(const Iterator &o) const noexcept
+      {
+        return !(*this == o);
+      }
+
+      constexpr StringView operator*() const noexcept
+      {
+        return StringView(cur, Size(nl - cur));
+      }
+    };
+
+  public:
+    constexpr Lines(StringView _text) noexcept
+        : text(_text) {}
+
+    constexpr auto range() const noexcept
+    {
+      return rangeof(*this);
+    }
+
+    constexpr Iterator begin() const noexcept
+    {
+      return Iterator(text.begin(), text.end());
+    }
+
+    constexpr Iterator end() const noexcept
+    {
+      return Iterator(text.end(), text.end());
+    }
+  };
+
+  // Whole file mapped read only. The mapping outlives the
+  // descriptor and is released on destruction : views into
+  // it must not outlive the MappedFile. Empty files map to
+  // an empty view.
+  class MappedFile
+  {
+    const char *map = nullptr;
+    Size lgth = 0;
+    bool valid = false;
+
+  public:
+    constexpr MappedFile() noexcept = default;
+
+    // Hints sequential access unless told otherwise.
+    explicit MappedFile(const char *path, bool sequential = true) noexcept
+    {
+      int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+
+      if (fd < 0)
+        return;
+
+      struct stat st;
+
+      if (::fstat(fd, &st) == 0)
+      {
+        lgth = Size(st.st_size);
+        valid = true;
+
+        if (lgth != 0)
+        {
+          void *p = ::mmap(nullptr, lgth, PROT_READ, MAP_PRIVATE, fd, 0);
+
+          if (p == MAP_FAILED)
+          {
+            lgth = 0;
+            valid = false;
+          }
+          else
+            map = static_cast<const char *>(p);
+        }
+      }
+
+      ::close(fd);
+
+      if (sequential)
+        advise(MADV_SEQUENTIAL);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&o) noexcept
+        : map(o.map), lgth(o.lgth), valid(o.valid)
+    {
+      o.map = nullptr;
+      o.lgth = 0;
+      o.valid = false;
+    }
+
+    MappedFile &operator=(MappedFile &&o) noexcept
+    {
+      if (this != &o)
+      {
+        unmap();
+        map = o.map;
+        lgth = o.lgth;
+        valid = o.valid;
+        o.map = nullptr;
+        o.lgth = 0;
+        o.valid = false;
+      }
+
+      return *this;
+    }
+
+    ~MappedFile() noexcept
+    {
+      unmap();
+    }
+
+  private:
+    void unmap() noexcept
+    {
+      if (map != nullptr)
+        ::munmap(const_cast<char *>(map), lgth);
+
+      map = nullptr;
+      lgth = 0;
+      valid = false;
+    }
+
+    void advise(int advice, Size off = 0, Size n = Size(-1)) noexcept
+    {
+      if (map == nullptr || off >= lgth)
+        return;
+
+      Size page = Size(::sysconf(_SC_PAGESIZE));
+      Size b = off & ~(page - 1);
+      Size e = n < lgth - off ? off + n : lgth;
+
+      ::madvise(const_cast<char *>(map) + b, e - b, advice);
+    }
+
+  public:
+    // false when the file could not be opened or mapped.
+    bool opened() const noexcept
+    {
+      return valid;
+    }
+
+    Size size() const noexcept
+    {
+      return lgth;
+    }
+
+    bool empty() const noexcept
+    {
+      return lgth == 0;
+    }
+
+    const char *data() const noexcept
+    {
+      return map;
+    }
+
+    StringView view() const noexcept
+    {
+      return StringView(map, lgth);
+    }
+
+    operator StringView() const noexcept
+    {
+      return view();
+    }
+
+    operator Span<const char>() const noexcept
+    {
+      return Span<const char>(map, lgth);
+    }
+
+    Lines lines() const noexcept
+    {
+      return Lines(view());
+    }
+
+  public:
+    // Pages will be read in order : more read ahead,
+    // earlier eviction behind.
+    void sequential() noexcept
+    {
+      advise(MADV_SEQUENTIAL);
+    }
+
+    // Starts reading [off, off + n) ahead of its use.
+    void willneed(Size off = 0, Size n = Size(-1)) noexcept
+    {
+      advise(MADV_WILLNEED, off, n);
+    }
+
+  public:
+    const char *begin() const noexcept
+    {
+      return map;
+    }
+
+    const char *end() const noexcept
+    {
+      return map + lgth;
+    }
+  };
+}
+
+#endif
@@ -79,9 +79,39 @@ concept IsSignedInteger = IsInteger<T> && !IsUnsignedInteger<T>;
 template <typename T>
 concept IsBoolean = same_as<T, bool>;
 
+template <typename T>
+concept IsFloating = is_any_of<T, float, double, const float, const double>;
+
 template <typename T>
 concept IsCharacter = is_any_of<T, char, wchar_t>;
 
+namespace meta
+{
+  template <typename T>
+  struct TriviallyCopyable
+  {
+    static constexpr bool value = __is_trivially_copyable(T);
+  };
+}
+
+template <typename T>
+concept TriviallyCopyable = meta::TriviallyCopyable<T>::value;
+
+namespace meta
+{
+  // Types for which moving to a new address and
+  // forgetting the old one equals a memcpy.
+  // Specialize to opt in non trivially copyable types.
+  template <typename T>
+  struct TriviallyRelocatable
+  {
+    static constexpr bool value = ::TriviallyCopyable<T>;
+  };
+}
+
+template <typename T>
+concept TriviallyRelocatable = meta::TriviallyRelocatable<T>::value;
+
 namespace meta
 {
 
@@ -0,0 +1,309 @@
+#ifndef __lib_parse_hpp__
+#define __lib_parse_hpp__
+
+#include <cstdlib>
+#include <cstring>
+
+#include <lib/basic_types.hpp>
+#include <lib/meta.hpp>
+#include <lib/string.hpp>
+#include <lib/floating.hpp>
+
+namespace lib
+{
+  enum class ParseError : int
+  {
+    none = 0,
+    invalid = 1,
+    overflow = 2
+  };
+
+  // Value read from the front of a StringView and the
+  // count of chars it was read from (0 when invalid).
+  template <typename T>
+  struct Parsed
+  {
+    T value;
+    Size consumed;
+    ParseError error;
+
+    constexpr bool ok() const noexcept
+    {
+      return error == ParseError::none;
+    }
+  };
+
+  constexpr bool isdigit(char c) noexcept
+  {
+    return '0' <= c && c <= '9';
+  }
+
+  // Eight chars, the first one in the lowest byte.
+  constexpr unsigned long long load8(const char *p) noexcept
+  {
+    unsigned long long v = 0;
+
+    if (__builtin_is_constant_evaluated())
+    {
+      for (Size i = 8; i > 0; --i)
+        v = v << 8 | (unsigned char)(p[i - 1]);
+
+      return v;
+    }
+
+    std::memcpy(&v, p, sizeof(v));
+
+    if constexpr (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+      v = __builtin_bswap64(v);
+
+    return v;
+  }
+
+  // SWAR : are the eight chars of v all digits ?
+  constexpr bool digits8(unsigned long long v) noexcept
+  {
+    return ((v & 0xF0F0F0F0F0F0F0F0) |
+            (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+           0x3333333333333333;
+  }
+
+  // SWAR : value of the eight digits of v, pairs, then
+  // quads, then the whole combined by multiplications.
+  constexpr unsigned long long value8(unsigned long long v) noexcept
+  {
+    v -= 0x3030303030303030;
+    v = v * 10 + (v >> 8);
+    return ((v & 0x000000FF000000FF) * (100 + (1000000ull << 32)) +
+            ((v >> 16) & 0x000000FF000000FF) * (1 + (10000ull << 32))) >>
+           32;
+  }
+
+  // Optional sign then decimal digits. Out of range values
+  // are consumed but give T() and ParseError::overflow.
+  template <IsInteger T>
+  constexpr Parsed<T> parse(StringView s) noexcept
+  {
+    const char *b = s.begin();
+    const char *e = s.end();
+    const char *p = b;
+    bool neg = false;
+
+    if (p != e && (*p == '-' || *p == '+'))
+    {
+      neg = *p == '-';
+      ++p;
+    }
+
+    const char *d = p;
+    unsigned long long v = 0;
+    bool over = false;
+
+    for (; e - p >= 8; p += 8)
+    {
+      unsigned long long chunk = load8(p);
+
+      if (!digits8(chunk))
+        break;
+
+      over |= __builtin_mul_overflow(v, 100000000ull, &v);
+      over |= __builtin_add_overflow(v, value8(chunk), &v);
+    }
+
+    for (; p != e && isdigit(*p); ++p)
+    {
+      over |= __builtin_mul_overflow(v, 10ull, &v);
+      over |= __builtin_add_overflow(v, (unsigned long long)(*p - '0'), &v);
+    }
+
+    if (p == d || (neg && IsUnsignedInteger<T> && v != 0))
+      return {T(), 0, ParseError::invalid};
+
+    constexpr Size bits = 8 * sizeof(T);
+    unsigned long long max;
+
+    if constexpr (IsSignedInteger<T>)
+      max = (1ull << (bits - 1)) - (neg ? 0 : 1);
+    else
+      max = ~0ull >> (64 - bits);
+
+    if (over || v > max)
+      return {T(), Size(p - b), ParseError::overflow};
+
+    return {T(neg ? 0 - v : v), Size(p - b), ParseError::none};
+  }
+
+  // Optional sign, digits with an optional point, optional
+  // exponent, or inf, infinity and nan. Decimal to binary is
+  // exact (ties to even) : Clinger's fast path when w 10^q is
+  // a product or a quotient of exact values, Eisel-Lemire on
+  // 19 significant digits otherwise, strtod when it gives up.
+  // Overflows give an infinity and ParseError::overflow.
+  template <IsFloating T>
+  inline Parsed<RemoveConstVolatile<T>> parse(StringView s) noexcept
+  {
+    using U = RemoveConstVolatile<T>;
+    using F = floating::Traits<U>;
+
+    const char *b = s.begin();
+    const char *e = s.end();
+    const char *p = b;
+    bool neg = false;
+
+    if (p != e && (*p == '-' || *p == '+'))
+    {
+      neg = *p == '-';
+      ++p;
+    }
+
+    auto word = [&](const char *w, Size n)
+    {
+      if (Size(e - p) < n)
+        return false;
+
+      for (Size i = 0; i < n; ++i)
+        if ((p[i] | 0x20) != w[i])
+          return false;
+
+      return true;
+    };
+
+    if (word("nan", 3))
+    {
+      U nan = __builtin_nan("");
+      return {neg ? -nan : nan, Size(p + 3 - b), ParseError::none};
+    }
+
+    if (word("inf", 3))
+    {
+      p += word("infinity", 8) ? 8 : 3;
+      U inf = __builtin_inf();
+      return {neg ? -inf : inf, Size(p - b), ParseError::none};
+    }
+
+    const char *mb = p;
+    unsigned long long w = 0;
+
+    auto digits = [&]()
+    {
+      for (; e - p >= 8 && digits8(load8(p)); p += 8)
+        w = w * 100000000 + value8(load8(p));
+
+      for (; p != e && isdigit(*p); ++p)
+        w = w * 10 + Size(*p - '0');
+    };
+
+    digits();
+
+    Size nd = Size(p - mb);
+    long long q = 0;
+
+    if (p != e && *p == '.')
+    {
+      const char *fb = ++p;
+      digits();
+      nd += Size(p - fb);
+      q = -(long long)(p - fb);
+    }
+
+    if (nd == 0)
+      return {U(), 0, ParseError::invalid};
+
+    const char *me = p;
+
+    if (p != e && (*p | 0x20) == 'e')
+    {
+      const char *x = p + 1;
+      bool eneg = false;
+
+      if (x != e && (*x == '-' || *x == '+'))
+        eneg = *x++ == '-';
+
+      if (x != e && isdigit(*x))
+      {
+        long long ex = 0;
+
+        for (; x != e && isdigit(*x); ++x)
+          if (ex < 100000)
+            ex = ex * 10 + (*x - '0');
+
+        q += eneg ? -ex : ex;
+        p = x;
+      }
+    }
+
+    Size consumed = Size(p - b);
+    bool truncated = false;
+
+    // Beyond 19 significant digits w wrapped : keep the
+    // first 19, the value lies between w and w + 1.
+    if (nd > 19)
+    {
+      const char *x = mb;
+      Size ns = nd;
+
+      for (; x != me && (*x == '0' || *x == '.'); ++x)
+        if (*x == '0')
+          --ns;
+
+      if (ns > 19)
+      {
+        w = 0;
+
+        for (Size i = 0; i < 19; ++x)
+          if (*x != '.')
+          {
+            w = w * 10 + Size(*x - '0');
+            ++i;
+          }
+
+        q += (long long)(ns - 19);
+        truncated = true;
+      }
+    }
+
+    U v = 0;
+    bool ok = true;
+
+    constexpr long long xmax = sizeof(F::powers) / sizeof(U) - 1;
+
+    if (!truncated && w <= (1ull << (F::mbits + 1)) && q >= -xmax && q <= xmax)
+      v = q < 0 ? U(w) / F::powers[-q] : U(w) * F::powers[q];
+    else
+    {
+      int qi = q < -400 ? -400 : q > 400 ? 400 : int(q);
+      auto bits = floating::nearest<U>(w, qi, ok);
+
+      if (ok && truncated)
+      {
+        bool ok1;
+        ok = floating::nearest<U>(w + 1, qi, ok1) == bits && ok1;
+      }
+
+      if (ok)
+        v = __builtin_bit_cast(U, bits);
+      else
+      {
+        String tmp(consumed + 1);
+        tmp.lappend(StringView(b, consumed));
+        tmp.lpush_back('\0');
+
+        if constexpr (same_as<U, float>)
+          v = std::strtof(tmp.data(), nullptr);
+        else
+          v = std::strtod(tmp.data(), nullptr);
+
+        v = v < 0 ? -v : v;
+      }
+    }
+
+    if (neg)
+      v = -v;
+
+    if (__builtin_isinf(v))
+      return {v, consumed, ParseError::overflow};
+
+    return {v, consumed, ParseError::none};
+  }
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <lib/meta.hpp>
 #include <lib/basic_types.hpp>
 #include <lib/utility.hpp>
+#include <lib/simd.hpp>
 
 namespace lib::op
 {
@@ -63,6 +64,24 @@ namespace lib::op
 
 namespace lib
 {
+  template <typename IT>
+  concept RandomAccessIterator = requires(IT b, IT e, Size n)
+  {
+    b[n];
+    b + n;
+    e - b;
+  };
+
+  template <typename IT, typename T>
+  concept ContiguousIteratorOf =
+      same_as<IT, T *> || same_as<IT, const T *>;
+
+  // Contiguous ranges of scalars are handed to the
+  // vector kernels outside of constant evaluation.
+  template <typename IT, typename T>
+  concept Vectorizable =
+      simd::Scalar<T> &&
+      ContiguousIteratorOf<IT, RemoveConstVolatile<T>>;
 
   struct FindIfAlgorithm
   {
@@ -84,6 +103,10 @@ namespace lib
     template <typename IT, typename T>
     constexpr IT operator()(IT b, IT e, const T &t) const noexcept
     {
+      if constexpr (Vectorizable<IT, T>)
+        if (!__builtin_is_constant_evaluated())
+          return b + (simd::find<RemoveConstVolatile<T>>(b, e, t) - b);
+
       return FindIfAlgorithm()(b, e, lib::op::Equals(t));
     }
   };
@@ -118,7 +141,8 @@ namespace lib
     template <typename IT, typename T>
     constexpr IT operator()(IT b, IT e, const T &t) const noexcept
     {
-      return AfterIfAlgorithm()(b, e, lib::op::Equals(t));
+      auto tmp = FindAlgorithm()(b, e, t);
+      return tmp == e ? e : ++tmp;
     }
   };
 
@@ -137,7 +161,7 @@ namespace lib
     template <typename IT, typename T>
     constexpr IT operator()(IT b, IT e, const T &t) const noexcept
     {
-      return BeforeIfAlgorithm()(b, e, lib::op::Equals(t));
+      return FindAlgorithm()(b, e, t);
     }
   };
 
@@ -165,7 +189,9 @@ namespace lib
     template <typename IT, typename T>
     constexpr decltype(auto) operator()(IT b, IT e, const T &t) const noexcept
     {
-      return AroundIfAlgorithm<R>()(b, e, lib::op::Equals(t));
+      IT fit = FindAlgorithm()(b, e, t);
+      return typename AroundIfAlgorithm<R>::AroundResult{
+          R(b, fit), R(fit != e ? ++fit : e, e)};
     }
   };
 
@@ -193,6 +219,10 @@ namespace lib
     template <typename IT, typename T>
     constexpr Size operator()(IT b, IT e, const T &t) const noexcept
     {
+      if constexpr (Vectorizable<IT, T>)
+        if (!__builtin_is_constant_evaluated())
+          return simd::count<RemoveConstVolatile<T>>(b, e, t);
+
       return CountIfAlgorithm()(b, e, lib::op::Equals(t));
     }
   };
@@ -210,6 +240,16 @@ namespace lib
     constexpr MismatchAlgorithm::Pair<IT, IT2> operator()(
         IT b, IT e, IT2 b2, IT2 e2) const noexcept
     {
+      using T = RemoveConstVolatilReference<decltype(*b)>;
+
+      if constexpr (Vectorizable<IT, T> && Vectorizable<IT2, T>)
+        if (!__builtin_is_constant_evaluated())
+        {
+          Size n = Size(e - b) < Size(e2 - b2) ? Size(e - b) : Size(e2 - b2);
+          Size i = simd::mismatch<T>(b, b2, n);
+          return {b + i, b2 + i};
+        }
+
       while (b != e && b2 != e2)
         if (*b == *b2)
         {
@@ -228,6 +268,10 @@ namespace lib
     template <typename IT, typename IT2>
     constexpr bool operator()(IT b, IT e, IT2 b2, IT2 e2) const noexcept
     {
+      if constexpr (RandomAccessIterator<IT> && RandomAccessIterator<IT2>)
+        if (Size(e - b) != Size(e2 - b2))
+          return false;
+
       auto &&[r1, r2] = MismatchAlgorithm()(b, e, b2, e2);
       return r1 == e && r2 == e2;
     }
@@ -238,10 +282,205 @@ namespace lib
     template <typename IT, typename IT2>
     constexpr bool operator()(IT b, IT e, IT2 b2, IT2 e2) const noexcept
     {
+      if constexpr (RandomAccessIterator<IT> && RandomAccessIterator<IT2>)
+        if (Size(e - b) < Size(e2 - b2))
+          return false;
+
       return MismatchAlgorithm()(b, e, b2, e2).second == e2;
     }
   };
 
+  // Crochemore-Perrin Two-Way matching : linear time and
+  // constant space. x and y only need an operator[].
+  struct TwoWayAlgorithm
+  {
+    template <typename X>
+    static constexpr long long suffix(
+        X x, long long m, long long &p, bool tilde) noexcept
+    {
+      long long ms = -1;
+      long long j = 0;
+      long long k = 1;
+      p = 1;
+
+      while (j + k < m)
+      {
+        auto a = x[j + k];
+        auto b = x[ms + k];
+
+        if (tilde ? b < a : a < b)
+        {
+          j += k;
+          k = 1;
+          p = j - ms;
+        }
+        else if (a == b)
+        {
+          if (k != p)
+            ++k;
+          else
+          {
+            j += p;
+            k = 1;
+          }
+        }
+        else
+        {
+          ms = j;
+          j = ms + 1;
+          k = p = 1;
+        }
+      }
+
+      return ms;
+    }
+
+    template <typename X, typename Y>
+    constexpr Size operator()(X x, Size _m, Y y, Size _n) const noexcept
+    {
+      long long m = _m;
+      long long n = _n;
+      long long p, q;
+      long long i = suffix(x, m, p, false);
+      long long j = suffix(x, m, q, true);
+      long long ell = i > j ? i : j;
+      long long per = i > j ? p : q;
+
+      bool periodic = per + ell + 1 <= m;
+
+      for (long long k = 0; periodic && k <= ell; ++k)
+        periodic = x[k] == x[k + per];
+
+      if (periodic)
+      {
+        long long memory = -1;
+
+        for (j = 0; j <= n - m;)
+        {
+          i = (ell > memory ? ell : memory) + 1;
+
+          while (i < m && x[i] == y[i + j])
+            ++i;
+
+          if (i >= m)
+          {
+            i = ell;
+
+            while (i > memory && x[i] == y[i + j])
+              --i;
+
+            if (i <= memory)
+              return Size(j);
+
+            j += per;
+            memory = m - per - 1;
+          }
+          else
+          {
+            j += i - ell;
+            memory = -1;
+          }
+        }
+      }
+      else
+      {
+        per = (ell + 1 > m - ell - 1 ? ell + 1 : m - ell - 1) + 1;
+
+        for (j = 0; j <= n - m;)
+        {
+          i = ell + 1;
+
+          while (i < m && x[i] == y[i + j])
+            ++i;
+
+          if (i >= m)
+          {
+            i = ell;
+
+            while (i >= 0 && x[i] == y[i + j])
+              --i;
+
+            if (i < 0)
+              return Size(j);
+
+            j += per;
+          }
+          else
+            j += i - ell;
+        }
+      }
+
+      return _n;
+    }
+  };
+
+  template <typename IT>
+  struct Reversed
+  {
+    IT last;
+
+    constexpr decltype(auto) operator[](long long i) const noexcept
+    {
+      return last[-i - 1];
+    }
+  };
+
+  struct SearchAlgorithm
+  {
+    template <RandomAccessIterator IT, RandomAccessIterator IT2>
+    constexpr IT operator()(IT b, IT e, IT2 b2, IT2 e2) const noexcept
+    {
+      Size n = Size(e - b);
+      Size m = Size(e2 - b2);
+
+      if (m == 0)
+        return b;
+
+      if (m > n)
+        return e;
+
+      if (m == 1)
+        return FindAlgorithm()(b, e, *b2);
+
+      using T = RemoveConstVolatilReference<decltype(*b)>;
+
+      if constexpr (Vectorizable<IT, T> && Vectorizable<IT2, T>)
+        if (!__builtin_is_constant_evaluated())
+        {
+          auto [at, done] = simd::search<T>(b, e, b2, m);
+          b = b + (at - b);
+
+          if (done)
+            return b;
+
+          n = Size(e - b);
+        }
+
+      Size i = TwoWayAlgorithm()(b2, m, b, n);
+      return i == n ? e : b + i;
+    }
+  };
+
+  struct SearchLastAlgorithm
+  {
+    template <RandomAccessIterator IT, RandomAccessIterator IT2>
+    constexpr IT operator()(IT b, IT e, IT2 b2, IT2 e2) const noexcept
+    {
+      Size n = Size(e - b);
+      Size m = Size(e2 - b2);
+
+      if (m == 0)
+        return e;
+
+      if (m > n)
+        return e;
+
+      Size i = TwoWayAlgorithm()(
+          Reversed<IT2>{e2}, m, Reversed<IT>{e}, n);
+      return i == n ? e : b + (n - i - m);
+    }
+  };
+
   struct AllOfAlgorithm
   {
     template <typename IT, typename P>
@@ -406,6 +645,21 @@ namespace lib
       return apply(StartsWithAlgorithm(), o.begin(), o.end());
     }
 
+    constexpr auto search(const Rangeable auto &o) const noexcept
+    {
+      return apply(SearchAlgorithm(), o.begin(), o.end());
+    }
+
+    constexpr auto search_last(const Rangeable auto &o) const noexcept
+    {
+      return apply(SearchLastAlgorithm(), o.begin(), o.end());
+    }
+
+    constexpr bool contains(const Rangeable auto &o) const noexcept
+    {
+      return o.begin() == o.end() || search(o) != end();
+    }
+
     constexpr Range after_if(auto &&pred) noexcept
     {
       return Range(apply(AfterIfAlgorithm(), pred), end());
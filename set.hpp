@@ -4,6 +4,7 @@
 #include <lib/list.hpp>
 #include <lib/basic_types.hpp>
 #include <lib/range.hpp>
+#include <lib/allocator.hpp>
 
 namespace lib
 {
@@ -16,10 +17,10 @@ namespace lib
     t1 < t2;
   };
 
-  template <LessComparable T>
+  template <LessComparable T, Allocator A = HeapAllocator>
   class Set
   {
-    List<T> storage;
+    List<T, A> storage;
 
   public:
     template <typename... U>
@@ -32,14 +33,19 @@ namespace lib
 
   public:
     Set() noexcept = default;
-    Set(Size _max) noexcept
-        : storage(_max)
+    explicit Set(A a) noexcept
+        : storage(a)
+    {
+    }
+
+    Set(Size _max, A a = A()) noexcept
+        : storage(_max, a)
     {
     }
 
     template <typename IT>
-    Set(IT b, IT e) noexcept
-        : Set()
+    Set(IT b, IT e, A a = A()) noexcept
+        : Set(a)
     {
       append(b, e);
     }
@@ -76,6 +82,11 @@ namespace lib
       return storage.empty();
     }
 
+    A allocator() const noexcept
+    {
+      return storage.allocator();
+    }
+
     void push(T &&t)
     {
       auto it = rangeof(*this).find_if(
@@ -0,0 +1,347 @@
+#ifndef __lib_simd_hpp__
+#define __lib_simd_hpp__
+
+#include <lib/basic_types.hpp>
+#include <lib/meta.hpp>
+
+// Vector kernels are selected at compile time : AVX2 when
+// the compiler targets it (-mavx2), SSE2 otherwise on x86.
+// Define LIB_NO_SIMD to force the scalar fallbacks.
+#if !defined(LIB_NO_SIMD) && (defined(__AVX2__) || defined(__SSE2__))
+#define LIB_SIMD 1
+#include <immintrin.h>
+#else
+#define LIB_SIMD 0
+#endif
+
+// Aligned block loads may read past the end of a
+// null terminated string, never past its last page.
+#if defined(__GNUC__)
+#define LIB_SIMD_UNCHECKED __attribute__((no_sanitize_address))
+#else
+#define LIB_SIMD_UNCHECKED
+#endif
+
+namespace lib::simd
+{
+  constexpr bool enabled = LIB_SIMD;
+
+  template <typename T>
+  concept Lane = sizeof(T) == 1 || sizeof(T) == 2 ||
+                 sizeof(T) == 4 || sizeof(T) == 8;
+
+  // Types whose equality is their bitwise equality.
+  template <typename T>
+  concept Scalar = Lane<T> &&
+                   (IsInteger<RemoveConstVolatile<T>> ||
+                    IsCharacter<RemoveConstVolatile<T>> ||
+                    is_any_of<RemoveConstVolatile<T>,
+                              signed char, unsigned char,
+                              char8_t, char16_t, char32_t>);
+
+#if LIB_SIMD
+
+#if defined(__AVX2__)
+  using Block = __m256i;
+
+  constexpr Size width = 32;
+
+  LIB_SIMD_UNCHECKED inline Block load(const void *p) noexcept
+  {
+    return _mm256_load_si256(static_cast<const Block *>(p));
+  }
+
+  inline Block loadu(const void *p) noexcept
+  {
+    return _mm256_loadu_si256(static_cast<const Block *>(p));
+  }
+
+  inline unsigned mask(Block b) noexcept
+  {
+    return unsigned(_mm256_movemask_epi8(b));
+  }
+
+  template <Size W>
+  inline Block splat(unsigned long long v) noexcept
+  {
+    if constexpr (W == 1)
+      return _mm256_set1_epi8(char(v));
+    else if constexpr (W == 2)
+      return _mm256_set1_epi16(short(v));
+    else if constexpr (W == 4)
+      return _mm256_set1_epi32(int(v));
+    else
+      return _mm256_set1_epi64x((long long)(v));
+  }
+
+  template <Size W>
+  inline Block equals(Block a, Block b) noexcept
+  {
+    if constexpr (W == 1)
+      return _mm256_cmpeq_epi8(a, b);
+    else if constexpr (W == 2)
+      return _mm256_cmpeq_epi16(a, b);
+    else if constexpr (W == 4)
+      return _mm256_cmpeq_epi32(a, b);
+    else
+      return _mm256_cmpeq_epi64(a, b);
+  }
+#else
+  using Block = __m128i;
+
+  constexpr Size width = 16;
+
+  LIB_SIMD_UNCHECKED inline Block load(const void *p) noexcept
+  {
+    return _mm_load_si128(static_cast<const Block *>(p));
+  }
+
+  inline Block loadu(const void *p) noexcept
+  {
+    return _mm_loadu_si128(static_cast<const Block *>(p));
+  }
+
+  inline unsigned mask(Block b) noexcept
+  {
+    return unsigned(_mm_movemask_epi8(b));
+  }
+
+  template <Size W>
+  inline Block splat(unsigned long long v) noexcept
+  {
+    if constexpr (W == 1)
+      return _mm_set1_epi8(char(v));
+    else if constexpr (W == 2)
+      return _mm_set1_epi16(short(v));
+    else if constexpr (W == 4)
+      return _mm_set1_epi32(int(v));
+    else
+      return _mm_set1_epi64x((long long)(v));
+  }
+
+  template <Size W>
+  inline Block equals(Block a, Block b) noexcept
+  {
+    if constexpr (W == 1)
+      return _mm_cmpeq_epi8(a, b);
+    else if constexpr (W == 2)
+      return _mm_cmpeq_epi16(a, b);
+    else if constexpr (W == 4)
+      return _mm_cmpeq_epi32(a, b);
+    else
+    {
+      Block c = _mm_cmpeq_epi32(a, b);
+      return _mm_and_si128(c, _mm_shuffle_epi32(c, 0b10110001));
+    }
+  }
+#endif
+
+  constexpr unsigned full = width == 32 ? 0xFFFFFFFFu : 0xFFFFu;
+
+  inline unsigned first(unsigned m) noexcept
+  {
+    return unsigned(__builtin_ctz(m));
+  }
+
+  inline unsigned count(unsigned m) noexcept
+  {
+    return unsigned(__builtin_popcount(m));
+  }
+
+  template <Lane C>
+  LIB_SIMD_UNCHECKED inline Size length(const C *s) noexcept
+  {
+    constexpr Size W = sizeof(C);
+
+    const char *p = reinterpret_cast<const char *>(s);
+    Size off = reinterpret_cast<Size>(p) & (width - 1);
+    const char *a = p - off;
+    Block zero = splat<W>(0);
+
+    unsigned m = mask(equals<W>(load(a), zero)) >> off;
+
+    if (m != 0)
+      return first(m) / W;
+
+    for (a += width;; a += width)
+    {
+      m = mask(equals<W>(load(a), zero));
+
+      if (m != 0)
+        return Size(a - p + first(m)) / W;
+    }
+  }
+
+  template <Scalar T>
+  inline const T *find(const T *b, const T *e, T v) noexcept
+  {
+    constexpr Size W = sizeof(T);
+    constexpr Size N = width / W;
+
+    Block needle = splat<W>((unsigned long long)(v));
+
+    for (; Size(e - b) >= N; b += N)
+    {
+      unsigned m = mask(equals<W>(loadu(b), needle));
+
+      if (m != 0)
+        return b + first(m) / W;
+    }
+
+    while (b != e && *b != v)
+      ++b;
+
+    return b;
+  }
+
+  template <Scalar T>
+  inline Size count(const T *b, const T *e, T v) noexcept
+  {
+    constexpr Size W = sizeof(T);
+    constexpr Size N = width / W;
+
+    Block needle = splat<W>((unsigned long long)(v));
+    Size cnt = 0;
+
+    for (; Size(e - b) >= N; b += N)
+      cnt += count(mask(equals<W>(loadu(b), needle))) / W;
+
+    for (; b != e; ++b)
+      if (*b == v)
+        ++cnt;
+
+    return cnt;
+  }
+
+  template <Scalar T>
+  inline Size mismatch(const T *a, const T *b, Size n) noexcept
+  {
+    constexpr Size W = sizeof(T);
+    constexpr Size N = width / W;
+
+    Size i = 0;
+
+    // The guard lets the compiler see short inputs never
+    // reach the loads, which -Warray-bounds would flag.
+    if (n >= N)
+      for (; i + N <= n; i += N)
+      {
+        unsigned m = mask(equals<W>(loadu(a + i), loadu(b + i)));
+
+        if (m != full)
+          return i + first(~m & full) / W;
+      }
+
+    while (i < n && a[i] == b[i])
+      ++i;
+
+    return i;
+  }
+
+  template <Scalar T>
+  struct Found
+  {
+    const T *at;
+    bool done;
+  };
+
+  // Candidates are the positions matching both the first and
+  // the last element of x. Gives up, telling where to resume,
+  // when verifying candidates costs too much compared to the
+  // haystack length or when less than a block is left.
+  template <Scalar T>
+  inline Found<T> search(const T *b, const T *e, const T *x, Size m) noexcept
+  {
+    constexpr Size W = sizeof(T);
+    constexpr Size N = width / W;
+
+    Block fst = splat<W>((unsigned long long)(x[0]));
+    Block lst = splat<W>((unsigned long long)(x[m - 1]));
+    const T *start = b;
+    Size work = 0;
+
+    for (; Size(e - b) >= N + m - 1; b += N)
+    {
+      unsigned c = mask(equals<W>(loadu(b), fst)) &
+                   mask(equals<W>(loadu(b + m - 1), lst));
+
+      while (c != 0)
+      {
+        Size k = first(c) / W;
+
+        if (mismatch(b + k + 1, x + 1, m - 2) == m - 2)
+          return {b + k, true};
+
+        work += m;
+        c &= ~(((1u << W) - 1) << (k * W));
+      }
+
+      if (work > 8 * Size(b - start) + 1024)
+        return {b + N, false};
+    }
+
+    return {b, false};
+  }
+
+#else
+
+  template <typename T>
+  struct Found
+  {
+    const T *at;
+    bool done;
+  };
+
+  template <typename T>
+  constexpr Found<T> search(const T *b, const T *, const T *, Size) noexcept
+  {
+    return {b, false};
+  }
+
+  template <typename T>
+  constexpr const T *find(const T *b, const T *e, T v) noexcept
+  {
+    while (b != e && *b != v)
+      ++b;
+
+    return b;
+  }
+
+  template <typename T>
+  constexpr Size count(const T *b, const T *e, T v) noexcept
+  {
+    Size cnt = 0;
+
+    for (; b != e; ++b)
+      if (*b == v)
+        ++cnt;
+
+    return cnt;
+  }
+
+  template <typename T>
+  constexpr Size mismatch(const T *a, const T *b, Size n) noexcept
+  {
+    Size i = 0;
+
+    while (i < n && a[i] == b[i])
+      ++i;
+
+    return i;
+  }
+
+  template <typename C>
+  constexpr Size length(const C *s) noexcept
+  {
+    Size i = 0;
+
+    while (s[i] != C(0))
+      ++i;
+
+    return i;
+  }
+
+#endif
+}
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef __lib_small_vector_hpp__
+#define __lib_small_vector_hpp__
+
+#include <new>
+#include <cstring>
+
+#include <lib/basic_types.hpp>
+#include <lib/range.hpp>
+#include <lib/utility.hpp>
+#include <lib/span.hpp>
+#include <lib/allocator.hpp>
+
+namespace lib
+{
+  // Vector keeping its N first elements inline and
+  // spilling to the allocator beyond.
+  template <typename T, Size N, Allocator A = HeapAllocator>
+    requires(N > 0)
+  class SmallVector
+  {
+    Size lgth = 0;
+    Size max = N;
+    T *storage = reinterpret_cast<T *>(buff);
+    [[no_unique_address]] A alloc;
+    alignas(T) unsigned char buff[N * sizeof(T)];
+
+  public:
+    template <typename... U>
+    static constexpr SmallVector from(U &&...us) noexcept
+    {
+      SmallVector v(sizeof...(U));
+      (v.lpush_back(forward<U>(us)), ...);
+      return v;
+    }
+
+  private:
+    constexpr bool inlined() const noexcept
+    {
+      return storage == reinterpret_cast<const T *>(buff);
+    }
+
+    constexpr void deallocate() noexcept
+    {
+      if (!inlined())
+        alloc.deallocate(storage, max * sizeof(T), alignof(T));
+
+      storage = reinterpret_cast<T *>(buff);
+      max = N;
+    }
+
+    constexpr void destroy() noexcept
+    {
+      for (Size i = 0; i < lgth; ++i)
+        storage[i].~T();
+
+      lgth = 0;
+    }
+
+    constexpr void steal(SmallVector &o) noexcept
+    {
+      if (o.inlined())
+      {
+        for (Size i = 0; i < o.lgth; ++i)
+        {
+          new (storage + i) T(move(o.storage[i]));
+          o.storage[i].~T();
+        }
+      }
+      else
+      {
+        storage = o.storage;
+        max = o.max;
+        o.storage = reinterpret_cast<T *>(o.buff);
+        o.max = N;
+      }
+
+      lgth = o.lgth;
+      o.lgth = 0;
+    }
+
+  public:
+    constexpr SmallVector() noexcept = default;
+
+    explicit constexpr SmallVector(A a) noexcept
+        : alloc(a)
+    {
+    }
+
+    explicit constexpr SmallVector(Size _max, A a = A()) noexcept
+        : alloc(a)
+    {
+      if (_max > N)
+        increase(_max - N);
+    }
+
+    template <typename IT>
+    constexpr SmallVector(IT b, IT e, A a = A()) noexcept
+        : SmallVector(a)
+    {
+      append(b, e);
+    }
+
+    constexpr SmallVector(const SmallVector &o) noexcept
+        : SmallVector(o.lgth, o.alloc)
+    {
+      lappend(o.begin(), o.end());
+    }
+
+    constexpr SmallVector(SmallVector &&o) noexcept
+        : alloc(o.alloc)
+    {
+      steal(o);
+    }
+
+    constexpr ~SmallVector() noexcept
+    {
+      destroy();
+      deallocate();
+    }
+
+    constexpr SmallVector &operator=(const SmallVector &o) noexcept
+    {
+      if (this != &o)
+      {
+        destroy();
+
+        if (max < o.lgth)
+          increase(o.lgth - max);
+
+        lappend(o.begin(), o.end());
+      }
+
+      return *this;
+    }
+
+    constexpr SmallVector &operator=(SmallVector &&o) noexcept
+    {
+      if (this != &o)
+      {
+        destroy();
+        deallocate();
+        alloc = o.alloc;
+        steal(o);
+      }
+
+      return *this;
+    }
+
+  public:
+    constexpr auto range() noexcept
+    {
+      return rangeof(*this);
+    }
+
+    constexpr auto range() const noexcept
+    {
+      return rangeof(*this);
+    }
+
+    constexpr Size size() const noexcept
+    {
+      return lgth;
+    }
+
+    constexpr Size capacity() const noexcept
+    {
+      return max;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+      return lgth == 0;
+    }
+
+    constexpr T *data() noexcept
+    {
+      return storage;
+    }
+
+    constexpr const T *data() const noexcept
+    {
+      return storage;
+    }
+
+    constexpr A allocator() const noexcept
+    {
+      return alloc;
+    }
+
+  public:
+    constexpr void increase(Size more) noexcept
+    {
+      if (more == 0)
+        return;
+
+      if constexpr (TriviallyRelocatable<T> &&
+                    ReallocatableAllocator<A>)
+        if (!inlined())
+        {
+          storage = static_cast<T *>(alloc.reallocate(
+              storage, max * sizeof(T), (max + more) * sizeof(T), alignof(T)));
+          max = max + more;
+          return;
+        }
+
+      T *nstorage = static_cast<T *>(
+          alloc.allocate((max + more) * sizeof(T), alignof(T)));
+
+      if constexpr (TriviallyRelocatable<T>)
+      {
+        if (lgth != 0)
+          std::memcpy(static_cast<void *>(nstorage), storage, lgth * sizeof(T));
+      }
+      else
+        for (Size i = 0; i < lgth; ++i)
+        {
+          new (nstorage + i) T(move(storage[i]));
+          storage[i].~T();
+        }
+
+      Size nmax = max + more;
+      deallocate();
+      storage = nstorage;
+      max = nmax;
+    }
+
+    constexpr void clear() noexcept
+    {
+      destroy();
+    }
+
+  public:
+    constexpr void lpush_back(const T &t) noexcept
+    {
+      if (lgth < max)
+      {
+        new (storage + lgth) T(t);
+        ++lgth;
+      }
+    }
+
+    constexpr void lpush_back(T &&t) noexcept
+    {
+      if (lgth < max)
+      {
+        new (storage + lgth) T(move(t));
+        ++lgth;
+      }
+    }
+
+    constexpr void push_back(const T &t) noexcept
+    {
+      if (lgth >= max)
+        increase(max * 2);
+
+      new (storage + lgth) T(t);
+      lgth = lgth + 1;
+    }
+
+    constexpr void push_back(T &&t) noexcept
+    {
+      if (lgth >= max)
+        increase(max * 2);
+
+      new (storage + lgth) T(move(t));
+      lgth = lgth + 1;
+    }
+
+    template <typename IT>
+    constexpr void lappend(IT b, IT e) noexcept
+    {
+      while (b != e)
+      {
+        lpush_back(*b);
+        ++b;
+      }
+    }
+
+    constexpr void lappend(Span<T> sp) noexcept
+    {
+      lappend(sp.begin(), sp.end());
+    }
+
+    constexpr void lappend(Span<const T> sp) noexcept
+    {
+      lappend(sp.begin(), sp.end());
+    }
+
+    template <typename IT>
+    constexpr void append(IT b, IT e) noexcept
+    {
+      while (b != e)
+      {
+        push_back(*b);
+        ++b;
+      }
+    }
+
+    constexpr void append(Span<T> sp) noexcept
+    {
+      append(sp.begin(), sp.end());
+    }
+
+    constexpr void append(Span<const T> sp) noexcept
+    {
+      append(sp.begin(), sp.end());
+    }
+
+    constexpr T &operator[](Size i) noexcept
+    {
+      return storage[i];
+    }
+
+    constexpr const T &operator[](Size i) const noexcept
+    {
+      return storage[i];
+    }
+
+    constexpr operator Span<const T>() const noexcept
+    {
+      return Span<const T>(data(), size());
+    }
+
+    constexpr operator Span<T>() noexcept
+    {
+      return Span<T>(data(), size());
+    }
+
+  public:
+    constexpr T *begin() noexcept
+    {
+      return storage;
+    }
+
+    constexpr T *end() noexcept
+    {
+      return storage + lgth;
+    }
+
+    constexpr const T *begin() const noexcept
+    {
+      return storage;
+    }
+
+    constexpr const T *end() const noexcept
+    {
+      return storage + lgth;
+    }
+  };
+}
+
+#endif
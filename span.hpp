@@ -161,6 +161,22 @@ namespace lib
     constexpr ~DelimitedSpan() noexcept = default;
     constexpr DelimitedSpan &operator=(const DelimitedSpan &) noexcept = default;
     constexpr DelimitedSpan &operator=(DelimitedSpan &&) noexcept = default;
+
+  public:
+    constexpr T *find(DelimitedSpan o) const noexcept
+    {
+      return this->range().search(o);
+    }
+
+    constexpr T *rfind(DelimitedSpan o) const noexcept
+    {
+      return this->range().search_last(o);
+    }
+
+    constexpr bool contains(DelimitedSpan o) const noexcept
+    {
+      return this->range().contains(o);
+    }
   };
 }
 #endif
\ No newline at end of file
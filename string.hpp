@@ -1,11 +1,14 @@
 #ifndef __lib_string_hpp__
 #define __lib_string_hpp__
 
+#include <cstring>
+
 #include <lib/vector.hpp>
 #include <lib/basic_types.hpp>
 #include <lib/utility.hpp>
 #include <lib/range.hpp>
 #include <lib/span.hpp>
+#include <lib/allocator.hpp>
 
 namespace lib
 {
@@ -19,40 +22,171 @@ namespace lib
 
   using StringSpan = BasicStringSpan<char>;
 
-  template <IsCharacter C>
+  // Strings up to sso characters are stored inline. The
+  // last byte of the representation tells the layout : in
+  // short mode it is the count of free inline characters
+  // (zero, so a terminator, when full), in long mode its
+  // high bit is set by the encoding of the capacity.
+  template <IsCharacter C, Allocator A = HeapAllocator>
   class BasicString
   {
+  public:
+    static constexpr Size sso = 3 * sizeof(Size) / sizeof(C) - 1;
+
+  private:
+    static constexpr bool little =
+        __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+    static constexpr Size lflag =
+        little ? Size(1) << (8 * sizeof(Size) - 1) : Size(0x80);
+
+    struct Long
+    {
+      C *ptr;
+      Size lgth;
+      Size max;
+    };
+
+    struct Short
+    {
+      C buff[sso];
+      C remain;
+    };
+
+    union Rep
+    {
+      Long l;
+      Short s;
+    };
+
+    Rep rep{.s = Short{{}, C(sso)}};
+    [[no_unique_address]] A alloc;
+
   private:
-    Vector<C> storage;
+    static constexpr Size encode(Size max) noexcept
+    {
+      return little ? max | lflag : max << 8 | lflag;
+    }
+
+    static constexpr Size decode(Size max) noexcept
+    {
+      return little ? max & ~lflag : max >> 8;
+    }
+
+    constexpr bool islong() const noexcept
+    {
+      return reinterpret_cast<const unsigned char *>(&rep)[sizeof(Rep) - 1] & 0x80;
+    }
+
+    constexpr void resize(Size n) noexcept
+    {
+      if (islong())
+        rep.l.lgth = n;
+      else
+        rep.s.remain = C(sso - n);
+    }
+
+    constexpr void reserve(Size n) noexcept
+    {
+      Size lgth = size();
+      Size max = capacity();
+
+      if (lgth + n > max)
+      {
+        Size more = lgth + n - max;
+        increase(more > max ? more : max);
+      }
+    }
+
+    constexpr void deallocate() noexcept
+    {
+      if (islong())
+        alloc.deallocate(rep.l.ptr, capacity() * sizeof(C), alignof(C));
+
+      rep.s = Short{{}, C(sso)};
+    }
+
+    constexpr void steal(BasicString &o) noexcept
+    {
+      rep = o.rep;
+      o.rep.s = Short{{}, C(sso)};
+    }
 
   public:
     BasicString() noexcept = default;
 
-    explicit constexpr BasicString(Size max) noexcept
-        : storage(max)
+    explicit constexpr BasicString(A a) noexcept
+        : alloc(a)
     {
     }
 
-    constexpr BasicString(BasicStringView<C> s) noexcept
-        : BasicString(s.size())
+    explicit constexpr BasicString(Size max, A a = A()) noexcept
+        : alloc(a)
+    {
+      if (max > sso)
+        increase(max - sso);
+    }
+
+    constexpr BasicString(BasicStringView<C> s, A a = A()) noexcept
+        : BasicString(s.size(), a)
     {
       lappend(s);
     }
 
-    constexpr BasicString(const C *o) noexcept
-        : BasicString(BasicStringView<C>(o))
+    constexpr BasicString(const C *o, A a = A()) noexcept
+        : BasicString(BasicStringView<C>(o), a)
     {
     }
 
     template <typename IT>
-    constexpr BasicString(IT b, IT e) noexcept
-        : storage(b, e) {}
+    constexpr BasicString(IT b, IT e, A a = A()) noexcept
+        : BasicString(a)
+    {
+      append(b, e);
+    }
+
+    constexpr BasicString(const BasicString &o) noexcept
+        : BasicString(BasicStringView<C>(o), o.alloc)
+    {
+    }
+
+    constexpr BasicString(BasicString &&o) noexcept
+        : alloc(o.alloc)
+    {
+      steal(o);
+    }
 
-    constexpr BasicString(const BasicString<C> &) noexcept = default;
-    constexpr BasicString(BasicString &&) noexcept = default;
-    constexpr ~BasicString() noexcept = default;
-    constexpr BasicString<C> &operator=(const BasicString<C> &) noexcept = default;
-    constexpr BasicString<C> &operator=(BasicString<C> &&) noexcept = default;
+    constexpr ~BasicString() noexcept
+    {
+      deallocate();
+    }
+
+    constexpr BasicString &operator=(const BasicString &o) noexcept
+    {
+      if (this != &o)
+      {
+        clear();
+
+        if (capacity() < o.size())
+          increase(o.size() - capacity());
+
+        lappend(BasicStringView<C>(o));
+      }
+
+      return *this;
+    }
+
+    constexpr BasicString &operator=(BasicString &&o) noexcept
+    {
+      if (this != &o)
+      {
+        deallocate();
+        alloc = o.alloc;
+        steal(o);
+      }
+
+      return *this;
+    }
 
   public:
     constexpr auto range() noexcept
@@ -67,116 +201,194 @@ namespace lib
 
     constexpr Size size() const noexcept
     {
-      return storage.size();
+      return islong() ? rep.l.lgth : sso - Size(rep.s.remain);
     }
 
     constexpr Size capacity() const noexcept
     {
-      return storage.capacity();
+      return islong() ? decode(rep.l.max) : sso;
     }
 
     constexpr bool empty() const noexcept
     {
-      return storage.empty();
+      return size() == 0;
     }
 
     constexpr C *data() noexcept
     {
-      return storage.data();
+      return islong() ? rep.l.ptr : rep.s.buff;
     }
 
     constexpr const C *data() const noexcept
     {
-      return storage.data();
+      return islong() ? rep.l.ptr : rep.s.buff;
+    }
+
+    constexpr A allocator() const noexcept
+    {
+      return alloc;
     }
 
   public:
     constexpr void increase(Size more) noexcept
     {
-      storage.increase(more);
+      if (more == 0)
+        return;
+
+      Size lgth = size();
+      Size max = capacity();
+      C *nstorage;
+
+      if constexpr (ReallocatableAllocator<A>)
+      {
+        if (islong())
+          nstorage = static_cast<C *>(alloc.reallocate(
+              rep.l.ptr, max * sizeof(C), (max + more) * sizeof(C), alignof(C)));
+        else
+        {
+          nstorage = static_cast<C *>(
+              alloc.allocate((max + more) * sizeof(C), alignof(C)));
+          std::memcpy(nstorage, rep.s.buff, lgth * sizeof(C));
+        }
+      }
+      else
+      {
+        nstorage = static_cast<C *>(
+            alloc.allocate((max + more) * sizeof(C), alignof(C)));
+        std::memcpy(nstorage, data(), lgth * sizeof(C));
+        deallocate();
+      }
+
+      rep.l = Long{nstorage, lgth, encode(max + more)};
     }
 
     constexpr void clear() noexcept
     {
-      storage.clear();
+      resize(0);
     }
 
   public:
     constexpr void lpush_back(C c) noexcept
     {
-      storage.lpush_back(c);
+      Size lgth = size();
+
+      if (lgth < capacity())
+      {
+        data()[lgth] = c;
+        resize(lgth + 1);
+      }
     }
 
     constexpr void push_back(C c) noexcept
     {
-      storage.push_back(c);
+      Size lgth = size();
+
+      if (lgth >= capacity())
+        increase(capacity() * 2);
+
+      data()[lgth] = c;
+      resize(lgth + 1);
     }
 
     constexpr void push_front(C c) noexcept
     {
-      storage.push_front(c);
+      Size lgth = size();
+
+      if (lgth >= capacity())
+        increase(capacity() * 2);
+
+      C *d = data();
+      std::memmove(d + 1, d, lgth * sizeof(C));
+      d[0] = c;
+      resize(lgth + 1);
     }
 
     template <typename IT>
     constexpr void lappend(IT b, IT e) noexcept
     {
-      storage.lappend(b, e);
+      if constexpr (ContiguousIteratorOf<IT, C>)
+      {
+        Size lgth = size();
+        Size room = capacity() - lgth;
+        Size n = Size(e - b) < room ? Size(e - b) : room;
+
+        if (n != 0)
+          std::memcpy(data() + lgth, b, n * sizeof(C));
+
+        resize(lgth + n);
+      }
+      else
+        while (b != e && size() < capacity())
+        {
+          lpush_back(*b);
+          ++b;
+        }
     }
 
     constexpr void lappend(const BasicString &o) noexcept
     {
-      storage.lappend(o.storage());
+      lappend(o.begin(), o.end());
     }
 
     constexpr void lappend(BasicString &&o) noexcept
     {
-      storage.lappend(move(o.storage()));
+      lappend(o.begin(), o.end());
     }
 
     constexpr void lappend(BasicStringView<C> o) noexcept
     {
-      storage.lappend(o);
+      lappend(o.begin(), o.end());
     }
 
     constexpr void lappend(BasicStringSpan<C> o) noexcept
     {
-      storage.lappend(o);
+      lappend(o.begin(), o.end());
     }
 
     constexpr void lappend(const C *o) noexcept
     {
-      storage.lappend(o, o + StrLen<C>()(o));
+      lappend(o, o + StrLen<C>()(o));
     }
 
     template <typename IT>
     constexpr void append(IT b, IT e) noexcept
     {
-      storage.append(b, e);
+      if constexpr (RandomAccessIterator<IT>)
+      {
+        reserve(Size(e - b));
+        lappend(b, e);
+      }
+      else
+        while (b != e)
+        {
+          push_back(*b);
+          ++b;
+        }
     }
 
     constexpr void append(const BasicString &o) noexcept
     {
-      storage.append(o.storage);
+      append(o.begin(), o.end());
     }
 
     constexpr void append(BasicString &&o) noexcept
     {
-      storage.append(move(o.storage));
+      append(o.begin(), o.end());
     }
 
     constexpr void append(BasicStringView<C> o) noexcept
     {
-      storage.append(o);
+      append(o.begin(), o.end());
     }
 
     constexpr void append(BasicStringSpan<C> o) noexcept
     {
-      storage.append(o);
+      append(o.begin(), o.end());
     }
 
     constexpr void append(const C *o) noexcept
     {
-      storage.append(o, o + StrLen<C>()(o));
+      append(o, o + StrLen<C>()(o));
     }
 
   public:
@@ -192,39 +404,45 @@ namespace lib
 
     constexpr C &operator[](Size i) noexcept
     {
-      return storage[i];
+      return data()[i];
     }
 
     constexpr const C &operator[](Size i) const noexcept
     {
-      return storage[i];
+      return data()[i];
     }
 
   public:
     constexpr C *begin() noexcept
     {
-      return storage.begin();
+      return data();
     }
 
     constexpr C *end() noexcept
     {
-      return storage.end();
+      return data() + size();
     }
 
     constexpr const C *begin() const noexcept
     {
-      return storage.begin();
+      return data();
     }
 
     constexpr const C *end() const noexcept
     {
-      return storage.end();
+      return data() + size();
     }
   };
 
   using String = BasicString<char>;
 }
 
+template <typename C, typename A>
+struct meta::TriviallyRelocatable<lib::BasicString<C, A>>
+{
+  static constexpr bool value = ::TriviallyRelocatable<A>;
+};
+
 template <lib::Size n>
 constexpr lib::String str(const char (&s) [n]) 
 {
@@ -3,6 +3,7 @@
 
 #include <lib/meta.hpp>
 #include <lib/basic_types.hpp>
+#include <lib/allocator.hpp>
 
 namespace lib
 {
@@ -12,17 +13,32 @@ namespace lib
     constexpr void operator()(T **p) const noexcept
     {
       delete (*p);
-      p = nullptr;
+      *p = nullptr;
     }
   };
 
+  // Strong<T[]> owns raw storage : elements are
+  // never constructed nor destroyed by it.
   template <typename T>
   struct StrongDeleter<T[]>
   {
     constexpr void operator()(T **p) const noexcept
     {
-      delete[](*p);
-      p = nullptr;
+      HeapAllocator().deallocate(*p, 0, alignof(T));
+      *p = nullptr;
+    }
+  };
+
+  template <typename T>
+  struct StrongAllocator;
+
+  template <typename T>
+  struct StrongAllocator<T[]>
+  {
+    T *operator()(Size n) const noexcept
+    {
+      return static_cast<T *>(
+          HeapAllocator().allocate(n * sizeof(T), alignof(T)));
     }
   };
 
@@ -52,6 +68,20 @@ namespace lib
 
     mutable pointer ptr = nullptr;
 
+  public:
+    static Strong allocate(Size n) noexcept
+        requires NativeArray<T>
+    {
+      return Strong(StrongAllocator<T>()(n));
+    }
+
+    constexpr pointer release() noexcept
+    {
+      pointer p = ptr;
+      ptr = nullptr;
+      return p;
+    }
+
   public:
     constexpr Strong() = default;
 
@@ -47,12 +47,23 @@ namespace lib::test
           logger::info("    |- /!\\ ", r.reason);
       }
 
-      size_t ntotal = res.size();
-      size_t nsucceed = res.range().find_if(
-          [](const Result &r)
-          { return r.success; });
+      logger::info("  |->>> tests ", nsucceeded(), '/', res.size(), "# succeed");
+    }
+
+    size_t nsucceeded() const noexcept
+    {
+      size_t nsucceed = 0;
+
+      for (const Result &r : res)
+        if (r.success)
+          ++nsucceed;
+
+      return nsucceed;
+    }
 
-      logger::info("  |->>> tests " nsucceed, '/', ntotal, "# succeed");
+    bool succeeded() const noexcept
+    {
+      return nsucceeded() == res.size();
     }
   };
 
@@ -0,0 +1,186 @@
+// Shortest round trip and exact fixed and scientific
+// formatting of float and double, against the C library.
+
+#include <lib/test.hpp>
+#include <lib/iostream.hpp>
+#include <lib/parse.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <random>
+
+using namespace lib;
+using namespace lib::test;
+
+namespace
+{
+  template <typename T>
+  auto bits(T v)
+  {
+    if constexpr (sizeof(T) == 4)
+      return __builtin_bit_cast(unsigned, v);
+    else
+      return __builtin_bit_cast(unsigned long long, v);
+  }
+
+  template <typename T>
+  T frombits(unsigned long long b)
+  {
+    if constexpr (sizeof(T) == 4)
+      return __builtin_bit_cast(T, unsigned(b));
+    else
+      return __builtin_bit_cast(T, b);
+  }
+
+  template <typename T>
+  T strto(const char *s)
+  {
+    if constexpr (sizeof(T) == 4)
+      return std::strtof(s, nullptr);
+    else
+      return std::strtod(s, nullptr);
+  }
+
+  // Written then parsed back, v must come back bit for bit,
+  // from no more digits than the shortest %.*e that does.
+  template <typename T>
+  void roundtrip(T v)
+  {
+    if (!std::isfinite(v))
+      return;
+
+    String s = StringWriter().write(v);
+    auto back = parse<T>(StringView(s.data(), s.size()));
+
+    assert::equals(StringWriter().write(s, " -> ", hex(bits(back.value))),
+                   StringWriter().write(s, " -> ", hex(bits(v))));
+
+    floating::Decimal d = floating::shortest(std::fabs(v));
+    int n = 1;
+
+    for (auto x = d.digits; x >= 10; x /= 10)
+      ++n;
+
+    char buf[64];
+    int m = 1;
+
+    for (; m < 17; ++m)
+    {
+      std::snprintf(buf, sizeof(buf), "%.*e", m - 1, double(v));
+
+      if (strto<T>(buf) == v)
+        break;
+    }
+
+    assert::equals(StringWriter().write(s, " digits ", n),
+                   StringWriter().write(s, " digits ", n <= m ? n : m));
+  }
+
+  template <typename T>
+  void neighbours(T v)
+  {
+    roundtrip(v);
+    roundtrip(std::nextafter(v, T(0)));
+    roundtrip(std::nextafter(v, T(INFINITY)));
+  }
+
+  void formats(double v, int p)
+  {
+    char ref[2048];
+
+    std::snprintf(ref, sizeof(ref), "%.*f", p, v);
+    String f = StringWriter().write(fixed(v, p));
+    assert::equals(StringWriter().write("fixed ", p, ' ', f),
+                   StringWriter().write("fixed ", p, ' ', StringView(ref)));
+
+    std::snprintf(ref, sizeof(ref), "%.*e", p, v);
+    String e = StringWriter().write(scientific(v, p));
+    assert::equals(StringWriter().write("scientific ", p, ' ', e),
+                   StringWriter().write("scientific ", p, ' ', StringView(ref)));
+  }
+}
+
+int main()
+{
+  auto suite = "floating"_suite(
+      "random doubles round trip"_test([]
+                                       {
+        std::mt19937_64 rng(42);
+
+        for (int i = 0; i < 200000; ++i)
+          roundtrip(frombits<double>(rng())); }),
+
+      "random floats round trip"_test([]
+                                      {
+        std::mt19937_64 rng(43);
+
+        for (int i = 0; i < 200000; ++i)
+          roundtrip(frombits<float>(rng())); }),
+
+      "subnormals round trip"_test([]
+                                   {
+        for (unsigned long long b = 1; b < 100000; ++b)
+        {
+          roundtrip(frombits<double>(b));
+          roundtrip(frombits<float>(b));
+        }
+
+        neighbours(2.2250738585072014e-308);
+        neighbours(1.17549435e-38f); }),
+
+      "powers of two round trip"_test([]
+                                      {
+        for (int e = -1074; e <= 1023; ++e)
+          neighbours(std::ldexp(1.0, e));
+
+        for (int e = -149; e <= 127; ++e)
+          neighbours(std::ldexp(1.0f, e));
+
+        roundtrip(1.7976931348623157e308);
+        roundtrip(3.4028235e38f); }),
+
+      "shortest digits of known values"_test([]
+                                             {
+        assert::equals(StringWriter().write(0.1), StringView("0.1"));
+        assert::equals(StringWriter().write(0.3f), StringView("0.3"));
+        assert::equals(StringWriter().write(5e-324), StringView("5e-324"));
+        assert::equals(StringWriter().write(-0.0), StringView("-0")); }),
+
+      "fixed and scientific edge precisions"_test([]
+                                                  {
+        const double values[] = {
+            0.0, -0.0, 0.5, 1.5, 2.5, -2.5, 0.125, 0.05, 0.15, 0.25,
+            0.35, 1e-7, 9.5, 99.5, 999.9999, 1e21, 1e22, 5e-324,
+            1.7976931348623157e308, 0.1, 0.3, 2.675, 1.005, 4.35, 0.045};
+
+        for (double v : values)
+          for (int p = 0; p < 30; ++p)
+            formats(v, p);
+
+        formats(1e300, 3);
+        formats(-1e-300, 310);
+        formats(5e-324, 330); }),
+
+      "fixed and scientific random values"_test([]
+                                                {
+        std::mt19937_64 rng(7);
+
+        for (int i = 0; i < 50000; ++i)
+        {
+          double v = frombits<double>(rng());
+
+          if (std::isfinite(v))
+            formats(v, int(rng() % 20));
+
+          // Short exact expansions, so many ties.
+          double t = std::ldexp(double(rng() % 100000000), -int(rng() % 40));
+          formats(t, int(rng() % 12));
+          formats(-t, int(rng() % 12));
+        } }));
+
+  auto res = suite.run();
+  res.print();
+  return res.succeeded() ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+// Binary logs decoded as the text mode writes them.
+
+#include <lib/test.hpp>
+#include <lib/logger.hpp>
+
+#include <cstdio>
+#include <unistd.h>
+
+using namespace lib;
+using namespace lib::test;
+
+namespace
+{
+  struct Collected
+  {
+    String s;
+
+    void append(char c) noexcept
+    {
+      s.push_back(c);
+    }
+
+    void append(StringView v) noexcept
+    {
+      s.append(v);
+    }
+  };
+
+  // What f logs through an Async in mode m.
+  template <typename F>
+  String logged(logger::mode m, F f)
+  {
+    std::FILE *tmp = std::tmpfile();
+    int fd = fileno(tmp);
+
+    {
+      logger::Async a(fd, 64 * 1024, logger::overflow::block, m);
+      f();
+    }
+
+    Collected c;
+    char buff[4096];
+    ::lseek(fd, 0, SEEK_SET);
+
+    for (ssize_t n; (n = ::read(fd, buff, sizeof(buff))) > 0;)
+      c.append(StringView(buff, Size(n)));
+
+    std::fclose(tmp);
+    return move(c.s);
+  }
+
+  template <typename F>
+  void roundtrip(F f)
+  {
+    String text = logged(logger::mode::text, f);
+    String log = logged(logger::mode::binary, f);
+    Collected decoded;
+
+    assert::equals(logger::decode(StringView(log.data(), log.size()), decoded), true);
+    assert::equals(decoded.s, text);
+  }
+}
+
+int main()
+{
+  logger::set_timestamps(false);
+
+  auto suite = "logger"_suite(
+      "decoded hex and bin match the text mode"_test([]
+                                                     {
+        roundtrip([]
+                  {
+          LIB_RECORD(logger::level::info, "{:x} {:b} {:x} {:b}", 'A', 'A', true, false);
+          LIB_RECORD(logger::level::info, "{:x} {:b}", (unsigned short)(0xBEEF), -2);
+          LIB_RECORD(logger::level::warn, "{:x} {:b}", 255u, (long long)(-1));
+          LIB_RECORD(logger::level::error, "{:x} {}", 1.5, 1.5); }); }),
+
+      "decoded scalars and strings match the text mode"_test([]
+                                                             {
+        roundtrip([]
+                  {
+          for (int i = 0; i < 100; ++i)
+            LIB_RECORD(logger::level::info, "i={} c={} b={} s={} f={:.3f} e={:e}",
+                       i, 'c', i % 2 == 0, StringView("sv"), i / 7.0, i * 1e10);
+
+          logger::warn("text in binary ", 42);
+          LIB_RECORD(logger::level::error, "no args {{}}"); }); }),
+
+      "truncated logs decode up to the cut record"_test([]
+                                                        {
+        auto f = []
+        {
+          for (int i = 0; i < 1000; ++i)
+            LIB_RECORD(logger::level::info, "line {} of {}", i, StringView("many"));
+        };
+
+        String text = logged(logger::mode::text, f);
+        String log = logged(logger::mode::binary, f);
+        Size last = text.size() - 1;
+
+        while (text.data()[last - 1] != '\n')
+          --last;
+
+        const Size cuts[] = {1, 3, 12};
+
+        for (Size cut : cuts)
+        {
+          Collected decoded;
+          bool ok = logger::decode(StringView(log.data(), log.size() - cut), decoded);
+
+          assert::equals(ok, false);
+          assert::equals(decoded.s, StringView(text.data(), last));
+        } }),
+
+      "corrupt definition ids are rejected"_test([]
+                                                 {
+        auto f = []
+        { LIB_RECORD(logger::level::info, "before {}", 1); };
+
+        String text = logged(logger::mode::text, f);
+        String log = logged(logger::mode::binary, f);
+
+        // Huge, and just past the end of the 10 bytes longer log.
+        const unsigned ids[] = {0xFFFFFFF0u, unsigned(log.size() + 11)};
+
+        for (unsigned id : ids)
+        {
+          Collected corrupt;
+          corrupt.append(StringView(log.data(), log.size()));
+          corrupt << 'D' << logger::raw(5u) << logger::raw(id) << char(0);
+
+          Collected decoded;
+          bool ok = logger::decode(StringView(corrupt.s.data(), corrupt.s.size()), decoded);
+
+          assert::equals(ok, false);
+          assert::equals(decoded.s, text);
+        } }),
+
+      "floods end with their suppressed count"_test([]
+                                                    {
+        String text = logged(logger::mode::text, []
+                             {
+          for (int i = 0; i < 25; ++i)
+            LIB_EVERY_N(10, logger::level::warn, "flood ", i); });
+
+        StringView lines(text.data(), text.size());
+        StringView last = StringView(": suppressed 4 messages\n");
+
+        assert::equals(lines.contains(StringView("warn : flood 20 (suppressed 9 messages)\n")), true);
+        assert::equals(StringView(lines.end() - last.size(), last.size()), last); }));
+
+  auto res = suite.run();
+  res.print();
+  return res.succeeded() ? 0 : 1;
+}
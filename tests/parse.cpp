@@ -0,0 +1,252 @@
+// parse<T> of integers and floating values : results
+// and consumed counts, floating values against strtod.
+
+#include <lib/test.hpp>
+#include <lib/parse.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+
+using namespace lib;
+using namespace lib::test;
+
+namespace
+{
+  template <typename T>
+  T strto(const char *s, char **end)
+  {
+    if constexpr (sizeof(T) == 4)
+      return std::strtof(s, end);
+    else
+      return std::strtod(s, end);
+  }
+
+  template <typename T>
+  auto bits(T v)
+  {
+    if constexpr (sizeof(T) == 4)
+      return __builtin_bit_cast(unsigned, v);
+    else
+      return __builtin_bit_cast(unsigned long long, v);
+  }
+
+  // Same value, bit for bit, and same count of chars read
+  // as the C library.
+  template <typename T>
+  void likestrtod(const char *s)
+  {
+    auto r = parse<T>(StringView(s));
+    char *end;
+    T ref = strto<T>(s, &end);
+
+    assert::equals(StringWriter().write(s, " -> ", hex(bits(r.value)), ' ', r.consumed),
+                   StringWriter().write(s, " -> ", hex(bits(ref)), ' ', Size(end - s)));
+  }
+
+  template <typename T>
+  void expect(const char *s, ParseError error, Size consumed, T value = T())
+  {
+    auto r = parse<T>(StringView(s));
+
+    assert::equals(StringWriter().write(s, " -> ", r.value, ' ', int(r.error), ' ', r.consumed),
+                   StringWriter().write(s, " -> ", value, ' ', int(error), ' ', consumed));
+  }
+
+  // Decimal string of a magnitude plus one.
+  std::string next(std::string s)
+  {
+    Size i = s.size();
+
+    while (i != 0 && s[i - 1] == '9')
+      s[--i] = '0';
+
+    if (i == 0 || s[i - 1] == '-')
+      s.insert(i, 1, '1');
+    else
+      ++s[i - 1];
+
+    return s;
+  }
+
+  template <typename T>
+  void bounds()
+  {
+    constexpr T max = std::numeric_limits<T>::max();
+    constexpr T min = std::numeric_limits<T>::min();
+
+    std::string smax = std::to_string(max);
+    std::string smin = std::to_string(min);
+    std::string over = next(smax);
+
+    expect<T>(smax.c_str(), ParseError::none, smax.size(), max);
+    expect<T>(over.c_str(), ParseError::overflow, over.size());
+    expect<T>((over + "x").c_str(), ParseError::overflow, over.size());
+    expect<T>("99999999999999999999999", ParseError::overflow, 23);
+
+    if constexpr (IsSignedInteger<T>)
+    {
+      std::string under = next(smin);
+
+      expect<T>(smin.c_str(), ParseError::none, smin.size(), min);
+      expect<T>(under.c_str(), ParseError::overflow, under.size());
+      expect<T>("-99999999999999999999999", ParseError::overflow, 24);
+    }
+    else
+    {
+      expect<T>("-1", ParseError::invalid, 0);
+      expect<T>("-0", ParseError::none, 2);
+    }
+  }
+}
+
+int main()
+{
+  auto suite = "parse"_suite(
+      "integer bounds at every width"_test([]
+                                           {
+        bounds<short>();
+        bounds<unsigned short>();
+        bounds<int>();
+        bounds<unsigned>();
+        bounds<long long>();
+        bounds<unsigned long long>(); }),
+
+      "integer syntax"_test([]
+                            {
+        expect<int>("+7", ParseError::none, 2, 7);
+        expect<int>("-0", ParseError::none, 2, 0);
+        expect<int>("12a", ParseError::none, 2, 12);
+        expect<int>("1234567812345678x", ParseError::overflow, 16);
+        expect<long long>("00000000000000000000000000000001", ParseError::none, 32, 1);
+        expect<int>("", ParseError::invalid, 0);
+        expect<int>("-", ParseError::invalid, 0);
+        expect<int>("a", ParseError::invalid, 0); }),
+
+      "signed zero, nan and infinities"_test([]
+                                             {
+        auto z = parse<double>(StringView("-0"));
+        assert::equals(z.consumed, Size(2));
+        assert::equals(z.ok(), true);
+        assert::equals(bits(z.value), bits(-0.0));
+
+        for (const char *s : {"nan", "NaN", "-nan"})
+        {
+          auto r = parse<double>(StringView(s));
+          assert::equals(std::isnan(r.value), true);
+          assert::equals(r.consumed, Size(std::strlen(s)));
+          assert::equals(r.ok(), true);
+        }
+
+        likestrtod<double>("infinity");
+        likestrtod<double>("Infinity");
+        likestrtod<double>("-inf");
+        likestrtod<double>("infinit");
+        likestrtod<float>("INF");
+        assert::equals(parse<double>(StringView("-infinity")).ok(), true); }),
+
+      "overflow to infinity"_test([]
+                                  {
+        expect<double>("1e309", ParseError::overflow, 5, INFINITY);
+        expect<double>("-1e400", ParseError::overflow, 6, -INFINITY);
+        expect<double>("1.7976931348623159e308", ParseError::overflow, 22, INFINITY);
+        expect<float>("3.5e38", ParseError::overflow, 6, INFINITY);
+        expect<double>("1.7976931348623157e308x", ParseError::none, 22,
+                       1.7976931348623157e308);
+        expect<double>("1e-400", ParseError::none, 6, 0.0); }),
+
+      "more than 19 significant digits"_test([]
+                                             {
+        const char *cases[] = {
+            "123456789012345678901234567890",
+            "12345678901234567890e-10",
+            "100000000000000000000000",
+            "9007199254740993.0000000000000000000001",
+            "0.000000000000000000000000000000000000000000001",
+            "0.00000000000000000000000000123456789012345678901234",
+            "2.4703282292062327208828439643411068618252990130716238221279284125033775e-324",
+            "179769313486231580793728971405303415079934132710037826936173778980444968292764750946649017977587207096330286416692887910946555547851940402630657488671505820681908902000708383676273854845817711531764475730270069855571366959622842914819860834936475292719074168444365510704342711559699508093042880177904174497791.9999999"};
+
+        for (const char *s : cases)
+        {
+          likestrtod<double>(s);
+          likestrtod<float>(s);
+        }
+
+        std::mt19937_64 rng(11);
+        char buf[64];
+
+        for (int i = 0; i < 100000; ++i)
+        {
+          double v = __builtin_bit_cast(double, rng());
+
+          if (!std::isfinite(v))
+            continue;
+
+          std::snprintf(buf, sizeof(buf), "%.*e", 19 + int(rng() % 20), v);
+          likestrtod<double>(buf);
+          likestrtod<float>(buf);
+        } }),
+
+      "halfway cases taking the strtod fallback"_test([]
+                                                      {
+        // Cut to 19 digits, w and w + 1 round apart.
+        likestrtod<double>("1.00000000000000011102230246251565404236316680908203125");
+        likestrtod<double>("1.00000000000000011102230246251565404236316680908203124");
+        likestrtod<double>("1.00000000000000011102230246251565404236316680908203126");
+        likestrtod<double>("9007199254740993");
+        likestrtod<double>("9007199254740993.0000000000000000000001");
+        likestrtod<double>("2.4703282292062328e-324");
+
+        std::mt19937_64 rng(12);
+        char buf[64];
+
+        for (int i = 0; i < 100000; ++i)
+        {
+          double v = __builtin_bit_cast(double, rng());
+
+          if (!std::isfinite(v))
+            continue;
+
+          long double mid = ((long double)(v) + std::nextafter(v, 1e300)) / 2;
+          std::snprintf(buf, sizeof(buf), "%.25Lg", mid);
+          likestrtod<double>(buf);
+        } }),
+
+      "short inputs like strtod"_test([]
+                                      {
+        for (const char *s : {"0", "1", "1.5", ".5", "5.", ".", "-", "+", "e5",
+                              "1e", "1e+", "1e-5x", "0.1", "7.038531e-26",
+                              "3.4028235e38", "1.17549435e-38", "1e-45", "1e23",
+                              "4503599627370496.5", "4503599627370497.5",
+                              "2.2250738585072011e-308", "2.2250738585072012e-308"})
+        {
+          likestrtod<double>(s);
+          likestrtod<float>(s);
+        }
+
+        std::mt19937_64 rng(13);
+        char buf[64];
+
+        for (int i = 0; i < 100000; ++i)
+        {
+          double v = __builtin_bit_cast(double, rng());
+
+          if (!std::isfinite(v))
+            continue;
+
+          std::snprintf(buf, sizeof(buf), "%.17g", v);
+          likestrtod<double>(buf);
+          std::snprintf(buf, sizeof(buf), "%.*g", 1 + int(rng() % 18), v);
+          likestrtod<double>(buf);
+          likestrtod<float>(buf);
+        } }));
+
+  auto res = suite.run();
+  res.print();
+  return res.succeeded() ? 0 : 1;
+}
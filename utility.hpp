@@ -3,6 +3,7 @@
 
 #include <lib/basic_types.hpp>
 #include <lib/meta.hpp>
+#include <lib/simd.hpp>
 
 namespace lib
 {
@@ -40,13 +41,27 @@ namespace lib
   template <typename C>
   struct StrLen
   {
-    constexpr Size operator()(const char *cs) const noexcept
+    [[gnu::always_inline]] constexpr Size operator()(const C *cs) const noexcept
     {
+      if (cs == nullptr)
+        return 0;
+
+      if constexpr (simd::enabled && simd::Lane<C>)
+        if (!__builtin_is_constant_evaluated())
+        {
+          // Keeps the length of literals known to the
+          // compiler, and their bounds to -Warray-bounds.
+          if constexpr (same_as<RemoveConstVolatile<C>, char>)
+            if (__builtin_constant_p(__builtin_strlen(cs)))
+              return __builtin_strlen(cs);
+
+          return simd::length(cs);
+        }
+
       Size i = 0;
 
-      if (cs != nullptr)
-        while (cs[i] != '\0')
-          ++i;
+      while (cs[i] != C(0))
+        ++i;
 
       return i;
     }
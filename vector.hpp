@@ -1,54 +1,95 @@
 #ifndef __lib_vector_hpp__
 #define __lib_vector_hpp__
 
+#include <new>
+#include <cstring>
+
 #include <lib/basic_types.hpp>
 #include <lib/range.hpp>
 #include <lib/strong.hpp>
+#include <lib/allocator.hpp>
 #include <lib/utility.hpp>
 #include <lib/span.hpp>
 
 namespace lib
 {
-  template <typename T>
+  template <typename T, Allocator A = HeapAllocator>
   class Vector
   {
     Size lgth = 0;
     Size max = 0;
-    Strong<T[]> storage;
+    T *storage = nullptr;
+    [[no_unique_address]] A alloc;
 
   public:
     template <typename... U>
     static constexpr Vector from(U &&...us) noexcept
     {
-      return Vector(
-          Strong<T[]>(new T[]{forward<U>(us)...}),
-          sizeof...(U));
+      Vector v(sizeof...(U));
+      (v.lpush_back(forward<U>(us)), ...);
+      return v;
+    }
+
+  private:
+    constexpr T *allocate(Size n) noexcept
+    {
+      return static_cast<T *>(alloc.allocate(n * sizeof(T), alignof(T)));
+    }
+
+    constexpr void reserve(Size n) noexcept
+    {
+      if (lgth + n > max)
+      {
+        Size more = lgth + n - max;
+        increase(more > max ? more : max);
+      }
+    }
+
+    constexpr void deallocate() noexcept
+    {
+      if (storage != nullptr)
+        alloc.deallocate(storage, max * sizeof(T), alignof(T));
+
+      storage = nullptr;
+    }
+
+    constexpr void destroy(Size from, Size to) noexcept
+    {
+      for (Size i = from; i < to; ++i)
+        storage[i].~T();
     }
 
   public:
     constexpr Vector() noexcept = default;
 
-    explicit constexpr Vector(Size _max) noexcept
+    explicit constexpr Vector(A a) noexcept
+        : alloc(a)
+    {
+    }
+
+    explicit constexpr Vector(Size _max, A a = A()) noexcept
         : lgth(0),
           max(_max),
-          storage{new T[max]}
+          alloc(a)
     {
+      storage = allocate(_max);
     }
 
     template <typename IT>
-    constexpr Vector(IT b, IT e) noexcept
-        : Vector()
+    constexpr Vector(IT b, IT e, A a = A()) noexcept
+        : Vector(a)
     {
       append(b, e);
     }
 
     constexpr Vector(Strong<T[]> &&fb, Size lgth) noexcept
+        requires same_as<A, HeapAllocator>
         : lgth(lgth),
           max(lgth),
-          storage(move(fb)) {}
+          storage(fb.release()) {}
 
     constexpr Vector(const Vector &o) noexcept
-        : Vector(o.max)
+        : Vector(o.max, o.alloc)
     {
       lappend(o.begin(), o.end());
     }
@@ -56,21 +97,29 @@ namespace lib
     constexpr Vector(Vector &&o) noexcept
         : lgth(o.lgth),
           max(o.max),
-          storage(move(o.storage))
+          storage(o.storage),
+          alloc(o.alloc)
     {
       o.lgth = 0;
       o.max = 0;
+      o.storage = nullptr;
     }
 
-    constexpr ~Vector() noexcept = default;
+    constexpr ~Vector() noexcept
+    {
+      destroy(0, lgth);
+      deallocate();
+    }
 
     constexpr Vector &operator=(const Vector &o) noexcept
     {
       if (this != &o)
       {
+        destroy(0, lgth);
+        deallocate();
         lgth = 0;
         max = o.max;
-        storage = new T[max];
+        storage = allocate(max);
         lappend(o.begin(), o.end());
       }
 
@@ -81,11 +130,15 @@ namespace lib
     {
       if (this != &o)
       {
+        destroy(0, lgth);
+        deallocate();
         lgth = o.lgth;
         max = o.max;
-        storage = move(o.storage);
+        storage = o.storage;
+        alloc = o.alloc;
         o.lgth = 0;
         o.max = 0;
+        o.storage = nullptr;
       }
 
       return *this;
@@ -127,23 +180,47 @@ namespace lib
       return storage;
     }
 
+    constexpr A allocator() const noexcept
+    {
+      return alloc;
+    }
+
   public:
     constexpr void increase(Size more) noexcept
     {
       if (more == 0)
         return;
-        
-      Strong<T[]> nstorage = new T[max + more];
 
-      for (Size i = 0; i < lgth; ++i)
-        nstorage[i] = move(storage[i]);
+      if constexpr (TriviallyRelocatable<T> &&
+                    ReallocatableAllocator<A>)
+        storage = static_cast<T *>(alloc.reallocate(
+            storage, max * sizeof(T), (max + more) * sizeof(T), alignof(T)));
+      else
+      {
+        T *nstorage = allocate(max + more);
+
+        if constexpr (TriviallyRelocatable<T>)
+        {
+          if (lgth != 0)
+            std::memcpy(static_cast<void *>(nstorage), storage, lgth * sizeof(T));
+        }
+        else
+          for (Size i = 0; i < lgth; ++i)
+          {
+            new (&nstorage[i]) T(move(storage[i]));
+            storage[i].~T();
+          }
+
+        deallocate();
+        storage = nstorage;
+      }
 
-      storage = move(nstorage);
       max = max + more;
     }
 
     constexpr void clear() noexcept
     {
+      destroy(0, lgth);
       lgth = 0;
     }
 
@@ -152,7 +229,7 @@ namespace lib
     {
       if (lgth < max)
       {
-        storage[lgth] = t;
+        new (&storage[lgth]) T(t);
         ++lgth;
       }
     }
@@ -161,7 +238,7 @@ namespace lib
     {
       if (lgth < max)
       {
-        storage[lgth] = move(t);
+        new (&storage[lgth]) T(move(t));
         ++lgth;
       }
     }
@@ -171,7 +248,7 @@ namespace lib
       if (lgth >= max)
         increase(max == 0 ? 10 : max * 2);
 
-      storage[lgth] = t;
+      new (&storage[lgth]) T(t);
       lgth = lgth + 1;
     }
 
@@ -180,7 +257,7 @@ namespace lib
       if (lgth >= max)
         increase(max == 0 ? 10 : max * 2);
 
-      storage[lgth] = move(t);
+      new (&storage[lgth]) T(move(t));
       lgth = lgth + 1;
     }
 
@@ -189,10 +266,18 @@ namespace lib
       if (lgth >= max)
         increase(max == 0 ? 10 : max * 2);
 
-      for (lib::Size i = lgth; i > 0; --i)
-        storage[i] = move(storage[i - 1]);
+      if (lgth == 0)
+        new (&storage[0]) T(t);
+      else
+      {
+        new (&storage[lgth]) T(move(storage[lgth - 1]));
+
+        for (lib::Size i = lgth - 1; i > 0; --i)
+          storage[i] = move(storage[i - 1]);
+
+        storage[0] = t;
+      }
 
-      storage[0] = t;
       lgth = lgth + 1;
     }
 
@@ -201,33 +286,62 @@ namespace lib
       if (lgth >= max)
         increase(max == 0 ? 10 : max * 2);
 
-      for (lib::Size i = lgth; i > 0; --i)
-        storage[i] = move(storage[i - 1]);
+      if (lgth == 0)
+        new (&storage[0]) T(move(t));
+      else
+      {
+        new (&storage[lgth]) T(move(storage[lgth - 1]));
+
+        for (lib::Size i = lgth - 1; i > 0; --i)
+          storage[i] = move(storage[i - 1]);
+
+        storage[0] = move(t);
+      }
 
-      storage[0] = move(t);
       lgth = lgth + 1;
     }
 
     constexpr void lappend(const Vector &o) noexcept
     {
-      for (const T &t : o)
-        lpush_back(t);
+      lappend(o.begin(), o.end());
     }
 
     constexpr void lappend(Vector &&o) noexcept
     {
-      for (T &&t : o)
-        lpush_back(move(t));
+      Size n = o.lgth < max - lgth ? o.lgth : max - lgth;
+
+      if constexpr (TriviallyRelocatable<T>)
+      {
+        if (n != 0)
+          std::memcpy(static_cast<void *>(storage + lgth), o.storage, n * sizeof(T));
+
+        lgth = lgth + n;
+        o.destroy(n, o.lgth);
+        o.lgth = 0;
+      }
+      else
+        for (Size i = 0; i < n; ++i)
+          lpush_back(move(o.storage[i]));
     }
 
     template <typename IT>
     constexpr void lappend(IT b, IT e) noexcept
     {
-      while (b != e)
+      if constexpr (ContiguousIteratorOf<IT, T> && TriviallyCopyable<T>)
       {
-        lpush_back(*b);
-        ++b;
+        Size n = Size(e - b) < max - lgth ? Size(e - b) : max - lgth;
+
+        if (n != 0)
+          std::memcpy(static_cast<void *>(storage + lgth), b, n * sizeof(T));
+
+        lgth = lgth + n;
       }
+      else
+        while (b != e && lgth < max)
+        {
+          lpush_back(*b);
+          ++b;
+        }
     }
 
     constexpr void lappend(Span<T> sp) noexcept
@@ -242,24 +356,29 @@ namespace lib
 
     constexpr void append(const Vector &o) noexcept
     {
-      for (const T &t : o)
-        push_back(t);
+      append(o.begin(), o.end());
     }
 
     constexpr void append(Vector &&o) noexcept
     {
-      for (T &&t : o)
-        push_back(move(t));
+      reserve(o.lgth);
+      lappend(move(o));
     }
 
     template <typename IT>
     constexpr void append(IT b, IT e) noexcept
     {
-      while (b != e)
+      if constexpr (RandomAccessIterator<IT>)
       {
-        push_back(*b);
-        ++b;
+        reserve(Size(e - b));
+        lappend(b, e);
       }
+      else
+        while (b != e)
+        {
+          push_back(*b);
+          ++b;
+        }
     }
 
     constexpr void append(Span<T> sp) noexcept
@@ -282,6 +401,16 @@ namespace lib
       return storage[i];
     }
 
+    constexpr operator Span<const T>() const noexcept
+    {
+      return Span<const T>(data(), size());
+    }
+
+    constexpr operator Span<T>() noexcept
+    {
+      return Span<T>(data(), size());
+    }
+
   public:
     constexpr T *begin() noexcept
     {
@@ -290,7 +419,7 @@ namespace lib
 
     constexpr T *end() noexcept
     {
-      return static_cast<T *>(storage) + lgth;
+      return storage + lgth;
     }
 
     constexpr const T *begin() const noexcept
@@ -300,9 +429,15 @@ namespace lib
 
     constexpr const T *end() const noexcept
     {
-      return static_cast<const T *>(storage) + lgth;
+      return storage + lgth;
     }
   };
 }
 
+template <typename T, typename A>
+struct meta::TriviallyRelocatable<lib::Vector<T, A>>
+{
+  static constexpr bool value = ::TriviallyRelocatable<A>;
+};
+
 #endif
\ No newline at end of file